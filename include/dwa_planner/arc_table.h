@@ -0,0 +1,65 @@
+// Copyright 2020 amsl
+
+/**
+ * @file arc_table.h
+ * @brief Unit speed arcs shared by the holonomic trajectories of the same yawrate
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_ARC_TABLE_H
+#define DWA_PLANNER_ARC_TABLE_H
+
+#include <vector>
+
+/**
+ * @class ArcTable
+ * @brief Keeps the arc traced at unit speed for every yawrate. A robot moving at (vx, vy) in its own frame traces the
+ * same arc rotated and scaled, so a trajectory of any linear velocity is a linear combination of the table rows.
+ */
+class ArcTable
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  ArcTable(void);
+
+  /**
+   * @brief Remove all arcs keeping the memory
+   * @param predict_time The simulated time
+   * @param steps The number of simulated states
+   */
+  void reset(const double predict_time, const int steps);
+
+  /**
+   * @brief Find the arc of the yawrate, adding it if it is not in the table
+   * @param yawrate The angular velocity of robot
+   * @return The index of arc
+   */
+  int add(const double yawrate);
+
+  /**
+   * @brief Compose the trajectory from the arc, each output array has steps elements
+   * @param index The index of arc
+   * @param velocity The linear velocity of robot along its x axis
+   * @param lateral_velocity The linear velocity of robot along its y axis
+   * @param x The x positions of trajectory
+   * @param y The y positions of trajectory
+   * @param yaw The orientations of trajectory
+   */
+  void rollout(
+      const int index, const float velocity, const float lateral_velocity, float *x, float *y, float *yaw) const;
+
+  int size(void) const { return yawrate_.size(); }
+
+private:
+  double predict_time_;
+  int steps_;
+  std::vector<double> yawrate_;
+  // the forward and leftward displacements at unit speed, sin(wt) / w and (1 - cos(wt)) / w
+  std::vector<float> forward_;
+  std::vector<float> leftward_;
+  std::vector<float> yaw_;
+};
+
+#endif  // DWA_PLANNER_ARC_TABLE_H
@@ -0,0 +1,58 @@
+// Copyright 2020 amsl
+
+/**
+ * @file cloud_filter.h
+ * @brief Height crop and voxel downsampling of point clouds into obstacles
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_CLOUD_FILTER_H
+#define DWA_PLANNER_CLOUD_FILTER_H
+
+#include <cstdint>
+#include <geometry_msgs/PoseArray.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <string>
+#include <vector>
+
+/**
+ * @class CloudFilter
+ * @brief Reads the points straight from the buffer of a cloud and keeps one obstacle per 2-D voxel
+ */
+class CloudFilter
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  CloudFilter(void);
+
+  /**
+   * @brief Get obstacle list from the point cloud
+   * @param cloud The point cloud in robot frame
+   * @param min_height The minimum height of points considered as obstacles
+   * @param max_height The maximum height of points considered as obstacles
+   * @param max_range Points farther than this from the robot are ignored
+   * @param voxel_size The size of a voxel column
+   * @param obs_list The obstacle list
+   * @return False if the cloud has no float x, y and z fields
+   */
+  bool filter(
+      const sensor_msgs::PointCloud2 &cloud, const double min_height, const double max_height, const double max_range,
+      const double voxel_size, geometry_msgs::PoseArray &obs_list);
+
+private:
+  /**
+   * @brief Get the offset of a float field
+   * @param cloud The point cloud
+   * @param name The name of field
+   * @return The offset of field in a point, or -1 if there is no such float field
+   */
+  int find_float_field(const sensor_msgs::PointCloud2 &cloud, const std::string &name) const;
+
+  // a voxel is occupied if its stamp equals the current generation, so the grid is never cleared
+  std::vector<uint32_t> stamps_;
+  uint32_t generation_;
+};
+
+#endif  // DWA_PLANNER_CLOUD_FILTER_H
@@ -0,0 +1,102 @@
+// Copyright 2020 amsl
+
+/**
+ * @file configuration_space.h
+ * @brief Yaw-binned configuration space obstacle maps for polygon footprints
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_CONFIGURATION_SPACE_H
+#define DWA_PLANNER_CONFIGURATION_SPACE_H
+
+#include <geometry_msgs/Polygon.h>
+#include <utility>
+#include <vector>
+
+#include "dwa_planner/distance_field.h"
+
+/**
+ * @class ConfigurationSpace
+ * @brief Occupancy and clearance of the robot footprint for a fixed set of yaw bins. The footprint is inflated by the
+ * error of the cells and of the bins, so the maps never miss a collision.
+ */
+class ConfigurationSpace
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  ConfigurationSpace(void);
+
+  /**
+   * @brief Set the robot footprint. The shapes of the bins are rebuilt only if something has changed.
+   * @param footprint The robot footprint in robot frame
+   * @param resolution The size of a cell
+   * @param yaw_bins The number of yaw bins
+   */
+  void set_footprint(const geometry_msgs::Polygon &footprint, const double resolution, const int yaw_bins);
+
+  /**
+   * @brief Clear the maps and set their size
+   * @param half_size The half width of the square grid centered on the robot
+   */
+  void reset(const double half_size);
+
+  /**
+   * @brief Register an obstacle
+   * @param x The x position of obstacle
+   * @param y The y position of obstacle
+   */
+  void add_obstacle(const double x, const double y);
+
+  /**
+   * @brief Compute the maps of all yaw bins from the registered obstacles
+   */
+  void compute(void);
+
+  /**
+   * @brief Check if the position is inside of the maps
+   * @param x The x position of robot
+   * @param y The y position of robot
+   * @return True if the position is inside of the maps
+   */
+  bool contains(const double x, const double y) const;
+
+  /**
+   * @brief Check if the footprint at the pose overlaps an obstacle
+   * @param x The x position of robot
+   * @param y The y position of robot
+   * @param yaw The orientation of robot
+   * @return True if the footprint overlaps an obstacle
+   */
+  bool is_colliding(const double x, const double y, const double yaw) const;
+
+  /**
+   * @brief Get the distance from the footprint at the pose to the nearest obstacle
+   * @param x The x position of robot
+   * @param y The y position of robot
+   * @param yaw The orientation of robot
+   * @return A conservative estimate of the distance from the footprint to the nearest obstacle
+   */
+  float distance(const double x, const double y, const double yaw) const;
+
+private:
+  /**
+   * @brief Get the yaw bin of the orientation
+   * @param yaw The orientation of robot
+   * @return The index of yaw bin
+   */
+  int to_bin(const double yaw) const;
+
+  double resolution_;
+  int yaw_bins_;
+  std::vector<std::pair<float, float>> footprint_;
+  // the covered range of x offsets for every y offset
+  std::vector<std::vector<std::pair<int, int>>> masks_;
+  DistanceField field_;
+  std::vector<uint8_t> occupied_;
+  std::vector<std::vector<float>> clearance_;
+  std::vector<std::pair<int, int>> obstacle_cells_;
+};
+
+#endif  // DWA_PLANNER_CONFIGURATION_SPACE_H
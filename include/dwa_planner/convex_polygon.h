@@ -0,0 +1,44 @@
+// Copyright 2020 amsl
+
+/**
+ * @file convex_polygon.h
+ * @brief Point queries against convex polygons with precomputed edge normals
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_CONVEX_POLYGON_H
+#define DWA_PLANNER_CONVEX_POLYGON_H
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+/**
+ * @brief Replace the points with their convex hull in counterclockwise order
+ * @param points The points
+ */
+void calc_convex_hull(std::vector<Eigen::Vector2d> &points);
+
+/**
+ * @brief Check if the point is inside of the convex polygon
+ * @param point The target point
+ * @param vertices The vertices of polygon
+ * @param edge_normals The outward unit normal of the edge from every vertex to the next one
+ * @return True if the point is inside of the polygon
+ */
+bool is_inside_of_convex_polygon(
+    const Eigen::Vector2d &point, const std::vector<Eigen::Vector2d> &vertices,
+    const std::vector<Eigen::Vector2d> &edge_normals);
+
+/**
+ * @brief Calculate the signed distance from the point to the boundary of the convex polygon
+ * @param point The target point
+ * @param vertices The vertices of polygon
+ * @param edge_normals The outward unit normal of the edge from every vertex to the next one
+ * @return The distance to the boundary, negative inside of the polygon
+ */
+double calc_signed_distance_to_convex_polygon(
+    const Eigen::Vector2d &point, const std::vector<Eigen::Vector2d> &vertices,
+    const std::vector<Eigen::Vector2d> &edge_normals);
+
+#endif  // DWA_PLANNER_CONVEX_POLYGON_H
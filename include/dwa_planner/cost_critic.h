@@ -0,0 +1,92 @@
+// Copyright 2020 amsl
+
+/**
+ * @file cost_critic.h
+ * @brief Interface of the critics scoring batches of candidate trajectories
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_COST_CRITIC_H
+#define DWA_PLANNER_COST_CRITIC_H
+
+#include <geometry_msgs/PoseArray.h>
+#include <ros/ros.h>
+#include "dwa_planner/obstacle_snapshot.h"
+#include "dwa_planner/path_distance.h"
+#include "dwa_planner/trajectory_store.h"
+
+#include <Eigen/Dense>
+
+namespace dwa_planner
+{
+/**
+ * @class CriticContext
+ * @brief A data class for what the critics share in a control cycle, all in the robot frame unless noted
+ */
+class CriticContext
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  CriticContext(void)
+      : goal_(Eigen::Vector3d::Zero()), max_velocity_(0.0), use_holonomic_(false),
+        robot_to_global_(Eigen::Isometry2d::Identity()), path_distance_(nullptr), obstacles_(nullptr),
+        obstacle_snapshot_(nullptr)
+  {
+  }
+
+  Eigen::Vector3d goal_;
+  // the maximum speed of the dynamic window, including the lateral velocity if the robot is holonomic
+  double max_velocity_;
+  // true if the trajectories have lateral velocities
+  bool use_holonomic_;
+  // the transform from the robot frame to the global frame in this cycle
+  Eigen::Isometry2d robot_to_global_;
+  // the distance to the whole global path in the global frame, nullptr if the path cost is not used
+  const PathDistance *path_distance_;
+  const geometry_msgs::PoseArray *obstacles_;
+  // the obstacles and the structures built from them, valid until the end of the cycle
+  const ObstacleSnapshot *obstacle_snapshot_;
+};
+
+/**
+ * @class CostCritic
+ * @brief A cost term of the planner. The critics which are not built in are loaded as pluginlib plugins of base class
+ * dwa_planner::CostCritic, and their costs are normalized over the valid candidates like the built-in ones.
+ */
+class CostCritic
+{
+public:
+  /**
+   * @brief Destructor
+   */
+  virtual ~CostCritic(void) {}
+
+  /**
+   * @brief Read the parameters of critic, called once after it is loaded
+   * @param nh The node handle in the namespace of critic
+   */
+  virtual void initialize(const ros::NodeHandle &nh) {}
+
+  /**
+   * @brief Update what the scores depend on, called once per control cycle before any score
+   * @param context The context of control cycle
+   */
+  virtual void prepare(const CriticContext &context) {}
+
+  /**
+   * @brief Score a batch of trajectories. Batches of a cycle are scored in parallel, so this must only write the costs
+   * of its own batch.
+   * @param trajectories The trajectory store
+   * @param indices The indices of trajectories in the trajectory store
+   * @param count The number of trajectories in the batch
+   * @param costs The costs indexed by the index of trajectory, INFEASIBLE_COST rejects the trajectory
+   */
+  virtual void score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const = 0;
+
+  static constexpr float INFEASIBLE_COST = 1e6;
+};
+}  // namespace dwa_planner
+
+#endif  // DWA_PLANNER_COST_CRITIC_H
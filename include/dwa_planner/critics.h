@@ -0,0 +1,145 @@
+// Copyright 2020 amsl
+
+/**
+ * @file critics.h
+ * @brief The built-in critics of obstacle, distance to goal, speed and path
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_CRITICS_H
+#define DWA_PLANNER_CRITICS_H
+
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseArray.h>
+#include "dwa_planner/cost_critic.h"
+#include "dwa_planner/footprint.h"
+#include "dwa_planner/obstacle_snapshot.h"
+#include "dwa_planner/path_distance.h"
+#include "dwa_planner/trajectory_store.h"
+
+#include <Eigen/Dense>
+
+/**
+ * @class ObstacleCritic
+ * @brief Scores the clearance of trajectories from the obstacles, rejecting the colliding ones. The obstacles are
+ * read from the snapshot of the cycle, which must outlive the scores of the cycle.
+ */
+class ObstacleCritic : public dwa_planner::CostCritic
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  ObstacleCritic(void);
+
+  /**
+   * @brief Set the parameters
+   * @param obs_range The distance beyond which obstacles do not affect the cost
+   * @param robot_radius The radius of robot
+   * @param footprint_padding The padding of footprint
+   * @param use_footprint True if the footprint is used instead of the circle of robot radius
+   * @param use_distance_field True if the distance field is looked up where it covers the states
+   */
+  void configure(
+      const double obs_range, const double robot_radius, const double footprint_padding, const bool use_footprint,
+      const bool use_distance_field);
+
+  void prepare(const dwa_planner::CriticContext &context) override;
+  void score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const override;
+
+  /**
+   * @brief Calculate obstacle cost of a trajectory
+   * @param trajectories The trajectory store
+   * @param index The index of estimated trajectory
+   * @return The obstacle cost, INFEASIBLE_COST if the robot collides
+   */
+  float calc_cost(const TrajectoryStore &trajectories, const int index) const;
+
+private:
+  /**
+   * @brief Calculate obstacle cost of circular robot from the obstacle list with the batched kernel
+   * @param trajectories The trajectory store
+   * @param index The index of estimated trajectory
+   * @return The obstacle cost
+   */
+  float calc_circle_cost(const TrajectoryStore &trajectories, const int index) const;
+
+  /**
+   * @brief Calculate the distance from robot footprint to the obstacle
+   * @param obstacle The position of obstacle
+   * @param to_robot The transform to the robot frame at the robot state
+   * @param footprint The robot footprint
+   * @return The distance from robot footprint to the obstacle, 0 if the obstacle is inside of robot footprint
+   */
+  float calc_dist_from_robot(
+      const geometry_msgs::Point &obstacle, const Eigen::Isometry2d &to_robot, const Footprint &footprint) const;
+
+  const ObstacleSnapshot *obstacles_;
+  double obs_range_;
+  double robot_radius_;
+  double footprint_padding_;
+  bool use_footprint_;
+  bool use_distance_field_;
+};
+
+/**
+ * @class ToGoalCritic
+ * @brief Scores the distance from the last state of trajectories to the goal
+ */
+class ToGoalCritic : public dwa_planner::CostCritic
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  ToGoalCritic(void);
+
+  void prepare(const dwa_planner::CriticContext &context) override;
+  void score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const override;
+
+private:
+  Eigen::Vector3d goal_;
+};
+
+/**
+ * @class SpeedCritic
+ * @brief Scores how much slower than the maximum velocity of the dynamic window trajectories are, by the speed
+ * including the lateral velocity if the robot is holonomic
+ */
+class SpeedCritic : public dwa_planner::CostCritic
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  SpeedCritic(void);
+
+  void prepare(const dwa_planner::CriticContext &context) override;
+  void score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const override;
+
+private:
+  double max_velocity_;
+  bool use_holonomic_;
+};
+
+/**
+ * @class PathCritic
+ * @brief Scores the mean distance from the states of trajectories to the global path
+ */
+class PathCritic : public dwa_planner::CostCritic
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  PathCritic(void);
+
+  void prepare(const dwa_planner::CriticContext &context) override;
+  void score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const override;
+
+private:
+  const PathDistance *path_distance_;
+  Eigen::Isometry2d robot_to_global_;
+};
+
+#endif  // DWA_PLANNER_CRITICS_H
@@ -0,0 +1,109 @@
+// Copyright 2020 amsl
+
+/**
+ * @file distance_field.h
+ * @brief Euclidean distance field for obstacle clearance lookups
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_DISTANCE_FIELD_H
+#define DWA_PLANNER_DISTANCE_FIELD_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class DistanceField
+ * @brief A robot-centered grid storing the nearest obstacle of every cell
+ */
+class DistanceField
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  DistanceField(void);
+
+  /**
+   * @brief Clear the field and set its geometry
+   * @param resolution The size of a cell
+   * @param half_size The half width of the square grid centered on the robot
+   */
+  void reset(const double resolution, const double half_size);
+
+  /**
+   * @brief Register an obstacle
+   * @param x The x position of obstacle
+   * @param y The y position of obstacle
+   * @return False if the obstacle is outside of the grid and was ignored
+   */
+  bool add_obstacle(const double x, const double y);
+
+  /**
+   * @brief Compute the distance transform of the registered obstacles
+   */
+  void compute(void);
+
+  /**
+   * @brief Compute the distance transform of occupied cells without registering obstacles
+   * @param occupied The occupancy of every cell of the grid
+   * @param dist The distance from the center of every cell to the center of the nearest occupied cell
+   */
+  void compute(const std::vector<uint8_t> &occupied, std::vector<float> &dist);
+
+  /**
+   * @brief Check if the position is inside of the grid
+   * @param x The x position
+   * @param y The y position
+   * @return True if the position is inside of the grid
+   */
+  bool contains(const double x, const double y) const;
+
+  /**
+   * @brief Get the distance from the position to the nearest obstacle, accurate to about one cell. It may
+   * overestimate the distance by up to about the diagonal of a cell.
+   * @param x The x position inside of the grid
+   * @param y The y position inside of the grid
+   * @return The distance to the nearest obstacle, or FLT_MAX if there is no obstacle
+   */
+  float distance(const double x, const double y) const;
+
+  /**
+   * @brief Get the index of the cell containing the position
+   * @param x The x position
+   * @param y The y position
+   * @return The index of the cell, or -1 if the position is outside of the grid
+   */
+  int to_index(const double x, const double y) const;
+
+  double resolution_;
+  double origin_;
+  int size_;
+
+private:
+  /**
+   * @brief Compute the 1-D squared distance transform of sampled function (Felzenszwalb and Huttenlocher)
+   * @param f The sampled function
+   * @param n The number of samples
+   * @param d The squared distance
+   * @param arg The index of the sample which gives the squared distance
+   */
+  void transform_1d(const float *f, const int n, float *d, int *arg);
+
+  std::vector<float> obstacle_x_;
+  std::vector<float> obstacle_y_;
+  std::vector<int> obstacle_cell_;
+  std::vector<float> sorted_x_;
+  std::vector<float> sorted_y_;
+  std::vector<int> cell_begin_;
+  std::vector<int> nearest_cell_;
+  std::vector<float> row_dist_;
+  std::vector<int> row_arg_;
+  std::vector<float> f_;
+  std::vector<float> d_;
+  std::vector<int> arg_;
+  std::vector<int> v_;
+  std::vector<float> z_;
+};
+
+#endif  // DWA_PLANNER_DISTANCE_FIELD_H
@@ -9,25 +9,56 @@
 #ifndef DWA_PLANNER_DWA_PLANNER_H
 #define DWA_PLANNER_DWA_PLANNER_H
 
+#include <atomic>
+#include <condition_variable>
 #include <geometry_msgs/PolygonStamped.h>
 #include <geometry_msgs/PoseArray.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/Twist.h>
+#include <memory>
+#include <message_filters/subscriber.h>
+#include <mutex>
 #include <nav_msgs/OccupancyGrid.h>
 #include <nav_msgs/Odometry.h>
 #include <nav_msgs/Path.h>
+#include <optional>
+#include <pluginlib/class_loader.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 #include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/PointCloud2.h>
 #include <std_msgs/Bool.h>
 #include <std_msgs/ColorRGBA.h>
 #include <std_msgs/Float64.h>
+#include <std_msgs/Int32.h>
 #include <string>
-#include <tf/tf.h>
-#include <tf/transform_listener.h>
+#include <tf2/utils.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/message_filter.h>
+#include <tf2_ros/transform_listener.h>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <visualization_msgs/Marker.h>
 #include <visualization_msgs/MarkerArray.h>
+#include "dwa_planner/arc_table.h"
+#include "dwa_planner/cloud_filter.h"
+#include "dwa_planner/configuration_space.h"
+#include "dwa_planner/cost_critic.h"
+#include "dwa_planner/critics.h"
+#include "dwa_planner/distance_field.h"
+#include "dwa_planner/footprint.h"
+#include "dwa_planner/lru_cache.h"
+#include "dwa_planner/obstacle_index.h"
+#include "dwa_planner/obstacle_snapshot.h"
+#include "dwa_planner/path_distance.h"
+#include "dwa_planner/primitive_library.h"
+#include "dwa_planner/ray_table.h"
+#include "dwa_planner/sampling_grid.h"
+#include "dwa_planner/scan_converter.h"
+#include "dwa_planner/thread_pool.h"
+#include "dwa_planner/trajectory_store.h"
 #include "traj_planner/Weights.h"
 
 #include <Eigen/Dense>
@@ -71,6 +102,8 @@ public:
     double yaw_;
     double velocity_;
     double yawrate_;
+    // the velocity along the y axis of robot, which is 0 unless the robot is holonomic
+    double lateral_velocity_;
 
   private:
   };
@@ -96,6 +129,8 @@ public:
     double max_velocity_;
     double min_yawrate_;
     double max_yawrate_;
+    double min_lateral_velocity_;
+    double max_lateral_velocity_;
 
   private:
   };
@@ -138,11 +173,31 @@ public:
     float to_goal_cost_;
     float speed_cost_;
     float path_cost_;
+    // the weighted sum of the costs of the critics loaded as plugins
+    float critic_cost_;
     float total_cost_;
 
   private:
   };
 
+  /**
+   * @class CandidateKeyHash
+   * @brief A hash of the primitive key and the lateral key of candidate
+   */
+  class CandidateKeyHash
+  {
+  public:
+    /**
+     * @brief Calculate the hash
+     * @param key The primitive key and the lateral key
+     * @return The hash
+     */
+    size_t operator()(const std::pair<uint64_t, int32_t> &key) const
+    {
+      return std::hash<uint64_t>()(key.first ^ (static_cast<uint64_t>(static_cast<uint32_t>(key.second)) << 16));
+    }
+  };
+
   /**
    * @brief Execute local path planning
    */
@@ -173,6 +228,11 @@ public:
    */
   void local_map_callback(const nav_msgs::OccupancyGridConstPtr &msg);
 
+  /**
+   * @brief A callback to handle buffering point cloud messages
+   */
+  void cloud_callback(const sensor_msgs::PointCloud2ConstPtr &msg);
+
   /**
    * @brief A callback to hanldle buffering odometry messages
    */
@@ -205,68 +265,88 @@ public:
   Window calc_dynamic_window(void);
 
   /**
-   * @brief Calculate obstacle cost
-   * @param traj The estimated trajectory
-   * @return The obstacle cost
+   * @brief Load the critics listed in CRITICS as plugins
    */
-  float calc_obs_cost(const std::vector<State> &traj);
+  void load_critics(void);
 
   /**
-   * @brief Calculate the distance of current pose to goal pose
-   * @param traj The estimated trajectory
+   * @brief Prepare every critic for this cycle
    * @param goal The pose of goal
-   * @return The distance of current pose to goal pose
-   */
-  float calc_to_goal_cost(const std::vector<State> &traj, const Eigen::Vector3d &goal);
-
-  /**
-   * @brief Calculate the speed cost
-   * @param traj The estimated trajectory
-   * @return The speed cost
+   * @param dynamic_window The dynamic window of this cycle
    */
-  float calc_speed_cost(const std::vector<State> &traj);
+  void prepare_critics(const Eigen::Vector3d &goal, const Window &dynamic_window);
 
   /**
-   * @brief Calculate the path cost
-   * @param traj The estimated trajectory
-   * @return The path cost
+   * @brief Calculate the weighted sum of the costs of the critics loaded as plugins
+   * @param index The index of trajectory
+   * @return The weighted sum of costs
    */
-  float calc_path_cost(const std::vector<State> &traj);
+  float calc_critic_cost(const int index);
 
   /**
-   * @brief Calculate the distance of current pose to global path
-   * @param state The robot state
-   * @return The distance of current pose to global path
+   * @brief Check if any critic loaded as a plugin rejects the trajectory
+   * @param index The index of trajectory
+   * @return True if the trajectory is rejected
    */
-  float calc_dist_to_path(const State state);
+  bool is_rejected_by_critics(const int index);
 
   /**
-   * @brief Simulate the robot motion
-   * @param state The start state of robot
+   * @brief Simulate the robot motion along the constant curvature arc from the robot pose in closed form
    * @param velocity The velocity of robot
    * @param yawrate The angular velocity of robot
+   * @param trajectory The simulated states
    */
-  void motion(State &state, const double velocity, const double yawrate);
+  void rollout(const double velocity, const double yawrate, std::vector<State> &trajectory);
 
   /**
    * @brief Get obstacle list from local map
    * @param map The local map
+   * @param obs_list The obstacle list
    */
-  void create_obs_list(const nav_msgs::OccupancyGrid &map);
+  void create_obs_list(const nav_msgs::OccupancyGrid &map, geometry_msgs::PoseArray &obs_list);
 
   /**
-   * @brief Get obstacle list from laser scan
+   * @brief Get obstacle list from laser scan already converted by the scan converter
    * @param scan The laser scan
+   * @param obs_list The obstacle list
    */
-  void create_obs_list(const sensor_msgs::LaserScan &scan);
+  void create_obs_list(const sensor_msgs::LaserScan &scan, geometry_msgs::PoseArray &obs_list);
 
   /**
-   * @brief Calculate the distance from robot footprint to the nearest obstacle
-   * @param obstacle The position of obstacle
-   * @param state The robot state
-   * @return The distance from robot footprint to the nearest obstacle
+   * @brief Get obstacle list from point cloud
+   * @param cloud The point cloud
+   * @param obs_list The obstacle list
+   */
+  void create_obs_list(const sensor_msgs::PointCloud2 &cloud, geometry_msgs::PoseArray &obs_list);
+
+  /**
+   * @brief Get the back buffer of the obstacle snapshot, which no other thread reads
+   * @return The back buffer with the current footprint
+   */
+  ObstacleSnapshot &acquire_obstacle_buffer(void);
+
+  /**
+   * @brief Build the obstacle structures of the back buffer from its obstacle list and publish it to the planner
+   */
+  void publish_obstacle_buffer(void);
+
+  /**
+   * @brief Calculate the half width of the area where obstacles can affect the obstacle cost
+   * @return The half width of the square area centered on the robot
    */
-  float calc_dist_from_robot(const geometry_msgs::Point &obstacle, const State &state);
+  double calc_obs_half_size(void);
+
+  /**
+   * @brief Build the obstacle index from the obstacle list
+   * @param snapshot The obstacle snapshot
+   */
+  void update_obs_index(ObstacleSnapshot &snapshot);
+
+  /**
+   * @brief Build the distance field, or the configuration space maps if footprint is used, from the obstacle list
+   * @param snapshot The obstacle snapshot
+   */
+  void update_distance_field(ObstacleSnapshot &snapshot);
 
   /**
    * @brief Move the robot footprint to the target pose
@@ -278,54 +358,113 @@ public:
   /**
    * @brief Check if the obstacle is inside of robot footprint
    * @param obstacle The position of obstacle
-   * @param footprint The robot footprint
-   * @param state The robot state
+   * @param to_robot The transform to the robot frame at the robot state
    * @return True if the obstacle is inside of robot footprint
    */
-  bool is_inside_of_robot(
-      const geometry_msgs::Point &obstacle, const geometry_msgs::PolygonStamped &footprint, const State &state);
+  bool is_inside_of_robot(const geometry_msgs::Point &obstacle, const Eigen::Isometry2d &to_robot);
 
   /**
-   * @brief Check if the target point is inside of triangle
-   * @param target_point The target point
-   * @param triangle The triangle
-   * @return True if the target point is inside of triangle
+   * @brief Calculate the transform from the frame of obstacles to the robot frame at the robot pose
+   * @param x The x position of robot
+   * @param y The y position of robot
+   * @param yaw The orientation of robot
+   * @return The transform to the robot frame
    */
-  bool is_inside_of_triangle(const geometry_msgs::Point &target_point, const geometry_msgs::Polygon &triangle);
-
-  /**
-   * @brief Calculate the intersection point of the line and the circle
-   * @param obstacle The position of obstacle
-   * @param state The robot state
-   * @param footprint The robot footprint
-   * @return The intersection point of the line and the circle
-   */
-  geometry_msgs::Point
-  calc_intersection(const geometry_msgs::Point &obstacle, const State &state, geometry_msgs::PolygonStamped footprint);
+  Eigen::Isometry2d calc_transform_to_robot(const double x, const double y, const double yaw);
 
   /**
    * @brief Generate trajectory
    * @param velocity The velocity of robot
    * @param yawrate The angular velocity of robot
-   * @return The generated trajectory
+   * @param trajectory The generated trajectory
    */
-  std::vector<State> generate_trajectory(const double velocity, const double yawrate);
+  void generate_trajectory(const double velocity, const double yawrate, std::vector<State> &trajectory);
 
   /**
    * @brief Generate trajectory
    * @param yawrate The angular velocity of robot
    * @param goal The pose of goal
-   * @return The generated trajectory
+   * @param trajectory The generated trajectory
    */
-  std::vector<State> generate_trajectory(const double yawrate, const Eigen::Vector3d &goal);
+  void generate_trajectory(const double yawrate, const Eigen::Vector3d &goal, std::vector<State> &trajectory);
 
   /**
-   * @brief Evaluate trajectory
-   * @param trajectory The estimated trajectory
-   * @param goal The pose of goal
-   * @return The cost of trajectory
+   * @brief Copy the trajectory into the trajectory store
+   * @param trajectory The trajectory
+   * @return The index of trajectory in the trajectory store
+   */
+  int add_trajectory(const std::vector<State> &trajectory);
+
+  /**
+   * @brief Copy the trajectory over the states of a trajectory in the trajectory store
+   * @param index The index of trajectory in the trajectory store
+   * @param trajectory The trajectory
+   */
+  void set_trajectory(const int index, const std::vector<State> &trajectory);
+
+  /**
+   * @brief Copy the states over the states of a trajectory in the trajectory store
+   * @param index The index of trajectory in the trajectory store
+   * @param x The x positions of states
+   * @param y The y positions of states
+   * @param yaw The orientations of states
+   */
+  void set_trajectory(const int index, const float *x, const float *y, const float *yaw);
+
+  /**
+   * @brief Map the primitive library, which is not used unless it is generated for the simulation parameters
+   */
+  void load_primitive_library(void);
+
+  /**
+   * @brief Calculate the key of the motion primitive the velocity and yawrate are snapped to
+   * @param velocity The velocity of robot
+   * @param yawrate The angular velocity of robot
+   * @return The key of motion primitive
+   */
+  uint64_t calc_primitive_key(const double velocity, const double yawrate);
+
+  /**
+   * @brief Calculate the velocity and yawrate of the motion primitive
+   * @param key The key of motion primitive
+   * @param velocity The snapped velocity of robot
+   * @param yawrate The snapped angular velocity of robot
+   */
+  void calc_primitive_velocity(const uint64_t key, double &velocity, double &yawrate);
+
+  /**
+   * @brief Get the trajectory of the motion primitive from the cache, generating it if it is not cached
+   * @param key The key of motion primitive
+   * @return The trajectory of motion primitive, valid until the next call
+   */
+  const std::vector<State> &get_primitive(const uint64_t key);
+
+  /**
+   * @brief Score a batch of trajectories with every critic, storing the costs and validity in the trajectory store.
+   * The obstacle cost is left to the branch and bound if it is used.
+   * @param indices The indices of trajectories
+   * @param count The number of trajectories
+   */
+  void evaluate_trajectories(const int *indices, const int count);
+
+  /**
+   * @brief Look up the transform from the global frame to the robot frame for this cycle
+   * @return False if the transform is not available
+   */
+  bool update_transform_snapshot(void);
+
+  /**
+   * @brief Wait for the next cycle of the sensor triggered mode, serving the callbacks meanwhile. The next cycle
+   * starts when new obstacles arrive, but not sooner than 1 / MAX_HZ or later than 1 / HZ after the current one.
+   * @param cycle_start The start time of current cycle
    */
-  Cost evaluate_trajectory(const std::vector<State> &trajectory, const Eigen::Vector3d &goal);
+  void wait_for_trigger(const ros::WallTime &cycle_start);
+
+  /**
+   * @brief Check if new obstacles have been published since the last check
+   * @return True if new obstacles have been published
+   */
+  bool take_trigger(void);
 
   /**
    * @brief Check if the robot can move
@@ -354,61 +493,163 @@ public:
   bool check_collision(const std::vector<State> &traj);
 
   /**
-   * @brief Normalize the costs
+   * @brief Add a candidate unless a candidate snapped to the same motion primitive has been added
+   * @param velocity The velocity of robot
+   * @param yawrate The angular velocity of robot
+   * @param lateral_velocity The lateral velocity of robot
+   * @return True if the candidate was added
+   */
+  bool add_candidate(const double velocity, const double yawrate, const double lateral_velocity = 0.0);
+
+  /**
+   * @brief Add the candidates of the sampled yawrates for the linear velocity
+   * @param velocity The velocity of robot
+   * @param lateral_velocity The lateral velocity of robot
+   * @param dynamic_window The dynamic window
+   * @param yawrate_grid The sampled yawrates
+   */
+  void add_yawrate_candidates(
+      const double velocity, const double lateral_velocity, const Window &dynamic_window,
+      const SamplingGrid &yawrate_grid);
+
+  /**
+   * @brief Generate and evaluate the candidates which are not in the trajectory store yet. If the deadline is used,
+   * they are evaluated in the order of priority and the ones left at the deadline are skipped.
+   * @param dynamic_window The dynamic window
+   */
+  void evaluate_candidates(const Window &dynamic_window);
+
+  /**
+   * @brief Calculate the yawrate of the candidate which stops the robot as much as the dynamic window allows
+   * @param dynamic_window The dynamic window
+   * @return The yawrate nearest to zero in the dynamic window
+   */
+  double calc_stop_yawrate(const Window &dynamic_window);
+
+  /**
+   * @brief Calculate the lateral velocity of the candidate which stops the robot as much as the dynamic window allows
+   * @param dynamic_window The dynamic window
+   * @return The lateral velocity nearest to zero in the dynamic window
+   */
+  double calc_stop_lateral_velocity(const Window &dynamic_window);
+
+  /**
+   * @brief Calculate the priority of evaluating the candidate, the neighbors of the last selected command come first,
+   * the stopping candidate next and the others by the distance from the last selected command
+   * @param index The index of candidate in the trajectory store
+   * @param dynamic_window The dynamic window
+   * @return The priority, a lower value comes first
+   */
+  float calc_priority(const int index, const Window &dynamic_window);
+
+  /**
+   * @brief Calculate the priority up to which the candidates are evaluated even after the deadline, which covers the
+   * neighbors of the last selected command and the stopping candidate
+   * @return The priority of the stopping candidate
+   */
+  float calc_required_priority(void);
+
+  /**
+   * @brief Check if the deadline of planning in this cycle has passed
+   * @return True if the deadline is used and has passed
+   */
+  bool is_past_deadline(void);
+
+  /**
+   * @brief Add the neighbors of the best valid candidates on a finer grid as new candidates
+   * @param dynamic_window The dynamic window, neighbors out of it are not added
+   * @param velocity_resolution The velocity step to the neighbors
+   * @param yawrate_resolution The yawrate step to the neighbors
+   * @param lateral_velocity_resolution The lateral velocity step to the neighbors, not used unless the robot is
+   * holonomic
+   * @return The number of added candidates
+   */
+  int refine_candidates(
+      const Window &dynamic_window, const double velocity_resolution, const double yawrate_resolution,
+      const double lateral_velocity_resolution);
+
+  /**
+   * @brief Calculate the total costs of the trajectories with the costs normalized by the range of the valid
+   * trajectories, leaving the costs in the trajectory store unchanged
+   * @param total_costs The total costs
+   */
+  void calc_normalized_total_costs(std::vector<float> &total_costs);
+
+  /**
+   * @brief Select the trajectory of minimum total cost, normalizing the costs by the range of the valid trajectories
+   * @param min_cost The cost of selected trajectory, kept if no trajectory has a lower total cost
+   * @return The index of selected trajectory, or -1 if there is no valid trajectory
+   */
+  int select_trajectory(Cost &min_cost);
+
+  /**
+   * @brief Select the trajectory of minimum total cost, normalizing the costs by fixed bounds and evaluating the
+   * obstacle cost only of trajectories which can still have the minimum total cost. Ties go to the lower index.
+   * @param min_cost The cost of selected trajectory, kept if no trajectory has a lower total cost
+   * @return The index of selected trajectory, or -1 if there is no valid trajectory
+   */
+  int select_trajectory_by_branch_and_bound(Cost &min_cost);
+
+  /**
+   * @brief Normalize one kind of cost of the valid trajectories
    * @param costs array of costs
+   * @param valid array of validity flags
    */
-  void normalize_costs(std::vector<Cost> &costs);
+  void normalize_costs(std::vector<float> &costs, const std::vector<uint8_t> &valid);
 
   /**
    * @brief Create a marker message
    * @param id The id of marker
    * @param scale The scale of marker
    * @param color The color of marker
-   * @param trajectory The estimated trajectory
+   * @param trajectories The trajectory store
+   * @param index The index of estimated trajectory
    * @param footprint The robot footprint
    */
   visualization_msgs::Marker create_marker_msg(
-      const int id, const double scale, const std_msgs::ColorRGBA color, const std::vector<State> &trajectory,
-      const geometry_msgs::PolygonStamped &footprint = geometry_msgs::PolygonStamped());
+      const int id, const double scale, const std_msgs::ColorRGBA color, const TrajectoryStore &trajectories,
+      const int index, const geometry_msgs::PolygonStamped &footprint = geometry_msgs::PolygonStamped());
 
   /**
    * @brief Publish selected trajectory
-   * @param trajectory Selected trajectry
+   * @param trajectories The trajectory store
+   * @param index The index of selected trajectry
    * @param pub Publisher of selected trajectory
    */
-  void visualize_trajectory(const std::vector<State> &trajectory, const ros::Publisher &pub);
+  void visualize_trajectory(const TrajectoryStore &trajectories, const int index, const ros::Publisher &pub);
 
   /**
    * @brief Publish candidate trajectories
    * @param trajectories Candidated trajectories
    * @param pub Publisher of candidate trajectories
    */
-  void visualize_trajectories(
-      const std::vector<std::pair<std::vector<State>, bool>> &trajectories, const ros::Publisher &pub);
+  void visualize_trajectories(const TrajectoryStore &trajectories, const ros::Publisher &pub);
 
   /**
    * @brief Publish predicted footprints
-   * @param trajectory Selected trajectry
+   * @param trajectories The trajectory store
+   * @param index The index of selected trajectry
    * @param pub Publisher of predicted footprints
    */
-  void visualize_footprints(const std::vector<State> &trajectory, const ros::Publisher &pub);
+  void visualize_footprints(const TrajectoryStore &trajectories, const int index, const ros::Publisher &pub);
 
   /**
-   * @brief Execute dwa planning
-   * @param window Dynamic window
+   * @brief Execute dwa planning, replacing the trajectories in the trajectory store by the candidates
    * @param goal Goal pose
-   * @param obs_list Obstacle's position
+   * @return The index of best trajectory in the trajectory store
    */
-  std::vector<State>
-  dwa_planning(const Eigen::Vector3d &goal, std::vector<std::pair<std::vector<State>, bool>> &trajectories);
+  int dwa_planning(const Eigen::Vector3d &goal);
 
 protected:
   std::string global_frame_;
   std::string robot_frame_;
+  std::string primitive_library_path_;
   double hz_;
+  double max_hz_;
   double target_velocity_;
   double max_velocity_;
   double min_velocity_;
+  double max_lateral_velocity_;
   double max_yawrate_;
   double min_yawrate_;
   double max_in_place_yawrate_;
@@ -424,6 +665,8 @@ protected:
   double to_goal_cost_gain_;
   double speed_cost_gain_;
   double path_cost_gain_;
+  double to_goal_cost_bound_;
+  double path_cost_bound_;
   double dist_to_goal_th_;
   double turn_direction_th_;
   double angle_to_goal_th_;
@@ -433,48 +676,138 @@ protected:
   double robot_radius_;
   double footprint_padding_;
   double v_path_width_;
+  double distance_field_resolution_;
+  double cloud_min_height_;
+  double cloud_max_height_;
+  double cloud_voxel_size_;
+  double primitive_resolution_;
+  double primitive_predict_time_;
   bool use_footprint_;
   bool use_scan_as_input_;
+  bool use_cloud_as_input_;
+  bool use_distance_field_;
   bool use_path_cost_;
+  bool use_branch_and_bound_;
+  bool use_holonomic_;
   bool use_speed_cost_;
-  bool odom_updated_;
-  bool local_map_updated_;
-  bool scan_updated_;
+  bool use_sensor_thread_;
+  bool use_sensor_trigger_;
   bool has_reached_;
   int velocity_samples_;
   int yawrate_samples_;
+  int lateral_velocity_samples_;
   int sim_time_samples_;
+  int yaw_bins_;
+  int ray_cast_threads_;
+  int evaluation_threads_;
+  int adaptive_sampling_levels_;
+  int adaptive_sampling_cells_;
+  int adaptive_sampling_budget_;
+  double planning_deadline_ratio_;
+  int primitive_cache_size_;
+  int primitive_sim_time_samples_;
   int subscribe_count_th_;
-  int odom_not_subscribe_count_;
-  int local_map_not_subscribe_count_;
-  int scan_not_subscribe_count_;
+  // the times the messages were received at [s], the ones of the sensors are shared with the sensor thread
+  double odom_received_time_;
+  std::atomic<double> local_map_received_time_;
+  std::atomic<double> scan_received_time_;
+  std::atomic<double> cloud_received_time_;
 
   ros::NodeHandle nh_;
   ros::NodeHandle local_nh_;
+  tf2_ros::Buffer tf_buffer_;
+  tf2_ros::TransformListener tf_listener_;
   ros::Publisher velocity_pub_;
   ros::Publisher candidate_trajectories_pub_;
   ros::Publisher selected_trajectory_pub_;
   ros::Publisher predict_footprints_pub_;
   ros::Publisher finish_flag_pub_, weights_pub;
+  ros::Publisher deadline_hits_pub_;
+  ros::Subscriber cloud_sub_;
   ros::Subscriber dist_to_goal_th_sub_;
-  ros::Subscriber edge_on_global_path_sub_;
+  message_filters::Subscriber<nav_msgs::Path> edge_on_global_path_sub_;
+  // passes the messages whose transforms are available
+  tf2_ros::MessageFilter<nav_msgs::Path> edge_on_global_path_filter_;
   ros::Subscriber footprint_sub_;
-  ros::Subscriber goal_sub_;
+  message_filters::Subscriber<geometry_msgs::PoseStamped> goal_sub_;
+  tf2_ros::MessageFilter<geometry_msgs::PoseStamped> goal_filter_;
   ros::Subscriber local_map_sub_;
   ros::Subscriber odom_sub_;
   ros::Subscriber scan_sub_;
   ros::Subscriber target_velocity_sub_, weights_sub;
+  // the queue of the sensor callbacks, served by the spinner if the sensor thread is used
+  ros::CallbackQueue sensor_queue_;
+  ros::AsyncSpinner sensor_spinner_;
 
   geometry_msgs::Twist current_cmd_vel_;
   std::optional<geometry_msgs::PoseStamped> goal_msg_;
-  geometry_msgs::PoseArray obs_list_;
+  // the latest obstacles, replaced as a whole by the sensor callbacks with atomic stores
+  std::shared_ptr<const ObstacleSnapshot> obstacle_snapshot_;
+  // the snapshot the sensor callbacks build next, reused unless the planner still holds it
+  std::shared_ptr<ObstacleSnapshot> obstacle_buffer_;
+  // the obstacles of the current cycle
+  std::shared_ptr<const ObstacleSnapshot> obstacles_;
+  // set when new obstacles are published, guarded by the mutex as the sensor thread may set it
+  bool has_new_obstacles_;
+  std::mutex trigger_mutex_;
+  std::condition_variable trigger_cv_;
+  RayTable ray_table_;
+  ScanConverter scan_converter_;
+  CloudFilter cloud_filter_;
+  LruCache<std::vector<State>> primitive_cache_;
+  std::vector<State> primitive_;
+  PrimitiveLibrary primitive_library_;
+  TrajectoryStore trajectories_;
+  ThreadPool evaluation_pool_;
+  // the trajectories generated by each thread of the evaluation pool
+  std::vector<std::vector<State>> thread_trajectories_;
+  std::vector<uint64_t> candidate_keys_;
+  // the lateral velocities of candidates divided by the primitive resolution
+  std::vector<int32_t> candidate_lateral_keys_;
+  // the keys of the candidates added in this cycle, for finding duplicates in constant time
+  std::unordered_set<std::pair<uint64_t, int32_t>, CandidateKeyHash> candidate_key_set_;
+  // the index of each candidate in the primitive library, or -1
+  std::vector<int> library_indices_;
+  ArcTable arc_table_;
+  // the index of each candidate in the arc table if the robot is holonomic
+  std::vector<int> arc_indices_;
+  std::vector<int> candidate_order_;
+  std::vector<float> candidate_costs_;
+  std::vector<int> evaluation_order_;
+  std::vector<float> candidate_priorities_;
+  // set for the candidates evaluated even after the deadline
+  std::vector<uint8_t> candidate_required_;
+  // set for the candidates whose costs except the obstacle cost have been evaluated
+  std::vector<uint8_t> candidate_evaluated_;
+  double last_velocity_;
+  double last_yawrate_;
+  double last_lateral_velocity_;
+  ros::WallTime deadline_;
+  // set by any thread of the evaluation pool which skips a candidate
+  std::atomic<bool> deadline_hit_;
+  int deadline_hit_count_;
   std::optional<geometry_msgs::PolygonStamped> footprint_;
-  std::optional<nav_msgs::Path> edge_points_on_path_;
+  // replaced as a whole when the footprint changes, as the sensor callbacks read it
+  std::shared_ptr<const Footprint> footprint_cache_;
+  ObstacleCritic obstacle_critic_;
+  ToGoalCritic to_goal_critic_;
+  SpeedCritic speed_critic_;
+  PathCritic path_critic_;
+  // the loader must outlive the critics it has created
+  pluginlib::ClassLoader<dwa_planner::CostCritic> critic_loader_;
+  std::vector<std::string> critic_names_;
+  std::vector<boost::shared_ptr<dwa_planner::CostCritic>> critics_;
+  std::vector<double> critic_gains_;
+  std::vector<double> critic_bounds_;
+  // the points of the path in the global frame, one per column
+  std::optional<Eigen::Matrix2Xd> edge_points_on_path_;
+  PathDistance path_distance_;
 
   std_msgs::Bool has_finished_;
 
-  tf::TransformListener listener_;
-  bool in_collision_ = false; 
+  // the transform from the global frame to the robot frame, looked up once per cycle
+  Eigen::Isometry2d global_to_robot_;
+  std::atomic<bool> in_collision_;
 };
 
 #endif  // DWA_PLANNER_DWA_PLANNER_H
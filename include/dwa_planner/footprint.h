@@ -0,0 +1,99 @@
+// Copyright 2020 amsl
+
+/**
+ * @file footprint.h
+ * @brief Cached robot footprint
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_FOOTPRINT_H
+#define DWA_PLANNER_FOOTPRINT_H
+
+#include <geometry_msgs/Polygon.h>
+#include <vector>
+
+#include <Eigen/Dense>
+
+/**
+ * @class Footprint
+ * @brief A data class for convex robot footprint, rebuilt only when the footprint or its padding changes
+ */
+class Footprint
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  Footprint(void);
+
+  /**
+   * @brief Update the footprint with a polygon
+   * @param polygon The robot footprint in robot frame
+   * @param padding The padding added to the footprint
+   * @return True if the footprint was rebuilt
+   */
+  bool update(const geometry_msgs::Polygon &polygon, const double padding);
+
+  /**
+   * @brief Update the footprint with a circle
+   * @param radius The radius of robot
+   * @param padding The padding added to the footprint
+   * @return True if the footprint was rebuilt
+   */
+  bool update(const double radius, const double padding);
+
+  /**
+   * @brief Move the footprint to the target pose
+   * @param x The x position of robot
+   * @param y The y position of robot
+   * @param yaw The orientation of robot
+   * @param points The vertices of moved footprint, reused between calls
+   */
+  void transform(const double x, const double y, const double yaw, std::vector<Eigen::Vector2d> &points) const;
+
+  /**
+   * @brief Move the footprint to the target pose
+   * @param x The x position of robot
+   * @param y The y position of robot
+   * @param yaw The orientation of robot
+   * @param polygon The moved footprint
+   */
+  void transform(const double x, const double y, const double yaw, geometry_msgs::Polygon &polygon) const;
+
+  /**
+   * @brief Check if the point is inside of the footprint
+   * @param point The target point in robot frame
+   * @return True if the point is inside of the footprint
+   */
+  bool contains(const Eigen::Vector2d &point) const;
+
+  /**
+   * @brief Calculate the signed distance from the point to the footprint
+   * @param point The target point in robot frame
+   * @return The distance to the boundary of the footprint, negative inside of it
+   */
+  double signed_distance(const Eigen::Vector2d &point) const;
+
+  std::vector<Eigen::Vector2d> vertices_;
+  std::vector<Eigen::Vector2d> edge_normals_;
+  double radius_;
+
+private:
+  /**
+   * @brief Set the unpadded vertices
+   * @param source The unpadded vertices
+   * @param padding The padding added to the footprint
+   * @return False if neither the vertices nor the padding has changed
+   */
+  bool set_source(const std::vector<Eigen::Vector2d> &source, const double padding);
+
+  /**
+   * @brief Rebuild the edge normals and the bounding radius from the padded vertices
+   */
+  void rebuild(void);
+
+  std::vector<Eigen::Vector2d> source_;
+  double padding_;
+};
+
+#endif  // DWA_PLANNER_FOOTPRINT_H
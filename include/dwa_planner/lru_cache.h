@@ -0,0 +1,109 @@
+// Copyright 2020 amsl
+
+/**
+ * @file lru_cache.h
+ * @brief Least recently used cache
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_LRU_CACHE_H
+#define DWA_PLANNER_LRU_CACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @class LruCache
+ * @brief A cache of values keyed by integers which evicts the least recently used value when it is full
+ */
+template <class Value>
+class LruCache
+{
+public:
+  /**
+   * @brief Constructor
+   * @param capacity The maximum number of values, at least one value is kept
+   */
+  explicit LruCache(const size_t capacity = 1024) : capacity_(capacity) {}
+
+  /**
+   * @brief Set the maximum number of values, evicting the least recently used ones if needed
+   * @param capacity The maximum number of values
+   */
+  void set_capacity(const size_t capacity)
+  {
+    capacity_ = capacity;
+    while (capacity_ < entries_.size())
+      evict();
+  }
+
+  /**
+   * @brief Remove all values
+   */
+  void clear(void)
+  {
+    entries_.clear();
+    index_.clear();
+  }
+
+  /**
+   * @brief Find the value and mark it as the most recently used one
+   * @param key The key of value
+   * @return The value, or nullptr if it is not cached
+   */
+  Value *find(const uint64_t key)
+  {
+    const auto it = index_.find(key);
+    if (it == index_.end())
+      return nullptr;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->second;
+  }
+
+  /**
+   * @brief Add a value as the most recently used one. When the cache is full, the least recently used value is
+   * evicted and its storage is reused without allocation.
+   * @param key The key of value, which must not be cached
+   * @return The added value to be filled by the caller, valid until it is evicted
+   */
+  Value &emplace(const uint64_t key)
+  {
+    if (!entries_.empty() && std::max<size_t>(capacity_, 1) <= entries_.size())
+    {
+      auto node = index_.extract(entries_.back().first);
+      node.key() = key;
+      entries_.splice(entries_.begin(), entries_, std::prev(entries_.end()));
+      entries_.front().first = key;
+      node.mapped() = entries_.begin();
+      index_.insert(std::move(node));
+      return entries_.front().second;
+    }
+    entries_.emplace_front(key, Value());
+    index_[key] = entries_.begin();
+    return entries_.front().second;
+  }
+
+  size_t size(void) const { return entries_.size(); }
+
+private:
+  /**
+   * @brief Remove the least recently used value
+   */
+  void evict(void)
+  {
+    if (entries_.empty())
+      return;
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+
+  size_t capacity_;
+  std::list<std::pair<uint64_t, Value>> entries_;
+  std::unordered_map<uint64_t, typename std::list<std::pair<uint64_t, Value>>::iterator> index_;
+};
+
+#endif  // DWA_PLANNER_LRU_CACHE_H
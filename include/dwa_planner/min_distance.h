@@ -0,0 +1,62 @@
+// Copyright 2020 amsl
+
+/**
+ * @file min_distance.h
+ * @brief Batched minimum distance between trajectory states and obstacles
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_MIN_DISTANCE_H
+#define DWA_PLANNER_MIN_DISTANCE_H
+
+/**
+ * @brief The implementations of the distance calculation, which give the same results
+ */
+enum class MinDistanceKernel
+{
+  SCALAR,
+  AVX2,
+  AVX512
+};
+
+/**
+ * @brief Check if the CPU runs the kernel
+ * @param kernel The kernel
+ * @return True if the kernel can be used
+ */
+bool is_supported(const MinDistanceKernel kernel);
+
+/**
+ * @brief Calculate the minimum squared distance between the states and the obstacles with the kernel
+ * @param kernel The kernel, which must be supported
+ * @param state_x The x positions of states
+ * @param state_y The y positions of states
+ * @param state_num The number of states
+ * @param obs_x The x positions of obstacles
+ * @param obs_y The y positions of obstacles
+ * @param obs_num The number of obstacles
+ * @param collision_sq_dist The calculation stops once a squared distance is less than this
+ * @param min_sq_dist The minimum squared distance so far, lowered by the states and obstacles
+ * @return True if a squared distance less than collision_sq_dist was found
+ */
+bool calc_min_squared_distance(
+    const MinDistanceKernel kernel, const float *state_x, const float *state_y, const int state_num,
+    const float *obs_x, const float *obs_y, const int obs_num, const float collision_sq_dist, float &min_sq_dist);
+
+/**
+ * @brief Calculate the minimum squared distance between the states and the obstacles with the fastest kernel
+ * @param state_x The x positions of states
+ * @param state_y The y positions of states
+ * @param state_num The number of states
+ * @param obs_x The x positions of obstacles
+ * @param obs_y The y positions of obstacles
+ * @param obs_num The number of obstacles
+ * @param collision_sq_dist The calculation stops once a squared distance is less than this
+ * @param min_sq_dist The minimum squared distance so far, lowered by the states and obstacles
+ * @return True if a squared distance less than collision_sq_dist was found
+ */
+bool calc_min_squared_distance(
+    const float *state_x, const float *state_y, const int state_num, const float *obs_x, const float *obs_y,
+    const int obs_num, const float collision_sq_dist, float &min_sq_dist);
+
+#endif  // DWA_PLANNER_MIN_DISTANCE_H
@@ -0,0 +1,135 @@
+// Copyright 2020 amsl
+
+/**
+ * @file obstacle_index.h
+ * @brief Uniform grid index over the obstacle list
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_OBSTACLE_INDEX_H
+#define DWA_PLANNER_OBSTACLE_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <geometry_msgs/PoseArray.h>
+#include <vector>
+
+/**
+ * @class ObstacleIndex
+ * @brief A grid bucketing the obstacles by cell for nearest neighbor and radius queries
+ */
+class ObstacleIndex
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  ObstacleIndex(void);
+
+  /**
+   * @brief Build the index
+   * @param obs_list The obstacle list
+   * @param cell_size The size of a cell
+   * @param half_size Obstacles farther than this from the robot in x or y are not indexed
+   */
+  void build(const geometry_msgs::PoseArray &obs_list, const double cell_size, const double half_size);
+
+  /**
+   * @brief Get the distance from the position to the nearest obstacle
+   * @param x The x position
+   * @param y The y position
+   * @param max_dist Obstacles farther than this are not searched
+   * @return The distance to the nearest obstacle, or FLT_MAX if there is no obstacle within max_dist
+   */
+  float nearest_distance(const double x, const double y, const double max_dist) const;
+
+  /**
+   * @brief Visit the obstacles within the radius until the function returns true
+   * @param x The x position
+   * @param y The y position
+   * @param radius The radius of search
+   * @param function The function called with the index of obstacle in the obstacle list
+   * @return True if the function returned true
+   */
+  template <class Function>
+  bool search_radius(const double x, const double y, const double radius, Function function) const
+  {
+    if (size_x_ == 0)
+      return false;
+    const int min_ix = std::max(to_cell(x - radius, origin_x_), 0);
+    const int max_ix = std::min(to_cell(x + radius, origin_x_), size_x_ - 1);
+    const int min_iy = std::max(to_cell(y - radius, origin_y_), 0);
+    const int max_iy = std::min(to_cell(y + radius, origin_y_), size_y_ - 1);
+    for (int iy = min_iy; iy <= max_iy; iy++)
+    {
+      for (int ix = min_ix; ix <= max_ix; ix++)
+      {
+        const int cell = ix + iy * size_x_;
+        for (int i = cell_begin_[cell]; i < cell_begin_[cell + 1]; i++)
+        {
+          if (hypot(x - x_[i], y - y_[i]) <= radius && function(index_[i]))
+            return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Visit the obstacles in the cells overlapping the box, a row of cells at a time
+   * @param min_x The minimum x position of box
+   * @param min_y The minimum y position of box
+   * @param max_x The maximum x position of box
+   * @param max_y The maximum y position of box
+   * @param function The function called with the range [begin, end) of obstacles in x_ and y_ until it returns true
+   * @return True if the function returned true
+   */
+  template <class Function>
+  bool search_box(const double min_x, const double min_y, const double max_x, const double max_y, Function function)
+      const
+  {
+    if (size_x_ == 0)
+      return false;
+    const int min_ix = std::max(to_cell(min_x, origin_x_), 0);
+    const int max_ix = std::min(to_cell(max_x, origin_x_), size_x_ - 1);
+    const int min_iy = std::max(to_cell(min_y, origin_y_), 0);
+    const int max_iy = std::min(to_cell(max_y, origin_y_), size_y_ - 1);
+    if (max_ix < min_ix)
+      return false;
+    // the obstacles of adjacent cells in a row are stored contiguously
+    for (int iy = min_iy; iy <= max_iy; iy++)
+    {
+      const int begin = cell_begin_[min_ix + iy * size_x_];
+      const int end = cell_begin_[max_ix + 1 + iy * size_x_];
+      if (begin < end && function(begin, end))
+        return true;
+    }
+    return false;
+  }
+
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<int> index_;
+
+private:
+  /**
+   * @brief Get the cell index along an axis
+   * @param position The position along the axis
+   * @param origin The origin of the grid along the axis
+   * @return The cell index
+   */
+  int to_cell(const double position, const double origin) const
+  {
+    return static_cast<int>(std::floor((position - origin) / cell_size_));
+  }
+
+  double cell_size_;
+  double origin_x_;
+  double origin_y_;
+  int size_x_;
+  int size_y_;
+  std::vector<int> cell_begin_;
+  std::vector<int> cell_;
+};
+
+#endif  // DWA_PLANNER_OBSTACLE_INDEX_H
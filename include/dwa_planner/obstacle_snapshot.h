@@ -0,0 +1,36 @@
+// Copyright 2020 amsl
+
+/**
+ * @file obstacle_snapshot.h
+ * @brief The obstacle structures built from one sensor message
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_OBSTACLE_SNAPSHOT_H
+#define DWA_PLANNER_OBSTACLE_SNAPSHOT_H
+
+#include <geometry_msgs/PoseArray.h>
+#include <memory>
+#include "dwa_planner/configuration_space.h"
+#include "dwa_planner/distance_field.h"
+#include "dwa_planner/footprint.h"
+#include "dwa_planner/obstacle_index.h"
+
+/**
+ * @class ObstacleSnapshot
+ * @brief A data class for the obstacles of one sensor message and the structures built from them, all in the robot
+ * frame. A snapshot is never modified once it is published to the planner, so it can be read while the next one is
+ * built.
+ */
+class ObstacleSnapshot
+{
+public:
+  geometry_msgs::PoseArray obs_list_;
+  ObstacleIndex obs_index_;
+  DistanceField distance_field_;
+  ConfigurationSpace configuration_space_;
+  // the footprint the configuration space was built for
+  std::shared_ptr<const Footprint> footprint_;
+};
+
+#endif  // DWA_PLANNER_OBSTACLE_SNAPSHOT_H
@@ -0,0 +1,82 @@
+// Copyright 2020 amsl
+
+/**
+ * @file path_distance.h
+ * @brief Distance to the global path polyline looked up from a grid around the robot
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_PATH_DISTANCE_H
+#define DWA_PLANNER_PATH_DISTANCE_H
+
+#include "dwa_planner/distance_field.h"
+
+#include <Eigen/Dense>
+
+/**
+ * @class PathDistance
+ * @brief Keeps the global path as a polyline sampled into a distance field, so the distance from a state to the whole
+ * path is a constant time lookup. The grid is a window of fixed size in the frame of the path, centered near the robot
+ * and built again only when the robot nears its edge, so its size does not depend on the length of the path. Where the
+ * nearest sample of the grid may be farther than a part of the path outside of the grid, the distance is calculated
+ * from the segments instead.
+ */
+class PathDistance
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  PathDistance(void);
+
+  /**
+   * @brief Set the path, the grid is built by the next update
+   * @param vertices The vertices of the path polyline in the frame of the path, one per column
+   */
+  void set_path(const Eigen::Matrix2Xd &vertices);
+
+  /**
+   * @brief Build the grid around the robot if there is none or the robot has moved too far from its center
+   * @param robot The position of the robot in the frame of the path
+   * @param resolution The size of a cell, the path is sampled at this spacing
+   * @param reach The distance from the robot to the farthest state looked up, the grid covers it until the robot moves
+   * by this distance
+   * @return True if the grid was built
+   */
+  bool update(const Eigen::Vector2d &robot, const double resolution, const double reach);
+
+  bool empty(void) const { return vertices_.cols() == 0; }
+
+  /**
+   * @brief Get the distance from the position to the path, accurate to about one cell inside of the grid
+   * @param x The x position in the frame of the path
+   * @param y The y position in the frame of the path
+   * @return The distance to the path, 0 if there is no path
+   */
+  float distance(const double x, const double y) const;
+
+private:
+  /**
+   * @brief Sample the part of the segment inside of the grid
+   * @param begin The beginning of the segment
+   * @param end The end of the segment
+   * @param resolution The spacing of samples
+   */
+  void add_segment(const Eigen::Vector2d &begin, const Eigen::Vector2d &end, const double resolution);
+
+  /**
+   * @brief Calculate the exact distance from the position to the segments of the path
+   * @param x The x position
+   * @param y The y position
+   * @return The distance to the path
+   */
+  float calc_segment_distance(const double x, const double y) const;
+
+  Eigen::Matrix2Xd vertices_;
+  // the center of the grid in the frame of the path
+  Eigen::Vector2d center_;
+  bool has_grid_;
+  DistanceField field_;
+};
+
+#endif  // DWA_PLANNER_PATH_DISTANCE_H
@@ -0,0 +1,176 @@
+// Copyright 2020 amsl
+
+/**
+ * @file primitive_library.h
+ * @brief Precomputed motion primitives memory-mapped from a file
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_PRIMITIVE_LIBRARY_H
+#define DWA_PLANNER_PRIMITIVE_LIBRARY_H
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Simulate the robot motion along the constant curvature arc from the origin in closed form
+ * @param velocity The velocity of robot
+ * @param yawrate The angular velocity of robot
+ * @param predict_time The simulated time
+ * @param steps The number of simulated states
+ * @param function The function called with the index, x position, y position and orientation of every state
+ */
+template <class Function>
+void rollout_arc(
+    const double velocity, const double yawrate, const double predict_time, const int steps, Function function)
+{
+  const double sim_time_step = predict_time / static_cast<double>(steps);
+  // rotate the heading by a fixed step instead of calling cos/sin for every state
+  const double step_cos = cos(yawrate * sim_time_step);
+  const double step_sin = sin(yawrate * sim_time_step);
+  double c = 1.0;
+  double s = 0.0;
+  for (int i = 0; i < steps; i++)
+  {
+    const double next_c = c * step_cos - s * step_sin;
+    s = s * step_cos + c * step_sin;
+    c = next_c;
+
+    const double time = (i + 1) * sim_time_step;
+    if (fabs(yawrate) < DBL_EPSILON)
+    {
+      // straight line limit of the arc
+      function(i, velocity * time, 0.0, yawrate * time);
+    }
+    else
+    {
+      // the point on the circle of radius v / w, with 1 - cos(yaw) written without cancellation
+      const double radius = velocity / yawrate;
+      function(i, radius * s, radius * (0.0 <= c ? s * s / (1.0 + c) : 1.0 - c), yawrate * time);
+    }
+  }
+}
+
+/**
+ * @class PrimitiveLibrary
+ * @brief The states of the motion primitives on a (v, w) grid, read from a file generated offline. The file is mapped
+ * read-only, so its pages are shared by every planner on the host.
+ */
+class PrimitiveLibrary
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  PrimitiveLibrary(void);
+
+  /**
+   * @brief Destructor
+   */
+  ~PrimitiveLibrary(void);
+
+  PrimitiveLibrary(const PrimitiveLibrary &) = delete;
+  PrimitiveLibrary &operator=(const PrimitiveLibrary &) = delete;
+
+  /**
+   * @brief Generate the library file
+   * @param path The path of file
+   * @param predict_time The simulated time of primitives
+   * @param steps The number of states of primitives
+   * @param resolution The spacing of the velocities and yawrates
+   * @param min_velocity The minimum velocity
+   * @param max_velocity The maximum velocity
+   * @param max_yawrate The maximum absolute yawrate
+   * @return False if the file could not be written
+   */
+  static bool generate(
+      const std::string &path, const double predict_time, const int steps, const double resolution,
+      const double min_velocity, const double max_velocity, const double max_yawrate);
+
+  /**
+   * @brief Calculate the number of primitives and the size of file generated with the parameters
+   * @param steps The number of states of primitives
+   * @param resolution The spacing of the velocities and yawrates
+   * @param min_velocity The minimum velocity
+   * @param max_velocity The maximum velocity
+   * @param max_yawrate The maximum absolute yawrate
+   * @param count The number of primitives
+   * @return The size of file in bytes, 0 if the parameters are invalid
+   */
+  static size_t calc_file_size(
+      const int steps, const double resolution, const double min_velocity, const double max_velocity,
+      const double max_yawrate, size_t &count);
+
+  /**
+   * @brief Map the library file, unmapping the current one
+   * @param path The path of file
+   * @return False if the file could not be mapped or is not a library of this version
+   */
+  bool load(const std::string &path);
+
+  /**
+   * @brief Unmap the library file
+   */
+  void unload(void);
+
+  bool is_loaded(void) const { return header_ != nullptr; }
+  int steps(void) const { return header_->steps; }
+  double predict_time(void) const { return header_->predict_time; }
+  double resolution(void) const { return header_->resolution; }
+
+  /**
+   * @brief Find the primitive
+   * @param velocity_index The velocity divided by the resolution
+   * @param yawrate_index The yawrate divided by the resolution
+   * @return The index of primitive, or -1 if it is out of the library or no library is loaded
+   */
+  int find(const int32_t velocity_index, const int32_t yawrate_index) const;
+
+  /**
+   * @brief Get the states of primitive, each array has steps elements
+   * @param index The index of primitive
+   * @return The array of x positions, y positions or orientations
+   */
+  const float *x(const int index) const { return states_ + static_cast<size_t>(index) * 3 * header_->steps; }
+  const float *y(const int index) const { return x(index) + header_->steps; }
+  const float *yaw(const int index) const { return x(index) + 2 * header_->steps; }
+
+  // incremented when the layout of file changes
+  static constexpr uint32_t VERSION = 1;
+
+private:
+  /**
+   * @brief The header of file, followed by x, y and yaw arrays of every primitive in native byte order. The
+   * primitives are ordered by velocity and then by yawrate.
+   */
+  struct Header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t steps;
+    double predict_time;
+    double resolution;
+    int32_t min_velocity_index;
+    int32_t velocity_count;
+    int32_t min_yawrate_index;
+    int32_t yawrate_count;
+  };
+
+  /**
+   * @brief Fill the header of file generated with the parameters
+   * @return False if the parameters are invalid
+   */
+  static bool make_header(
+      const double predict_time, const int steps, const double resolution, const double min_velocity,
+      const double max_velocity, const double max_yawrate, Header &header);
+
+  const Header *header_;
+  const float *states_;
+  void *data_;
+  size_t size_;
+};
+
+#endif  // DWA_PLANNER_PRIMITIVE_LIBRARY_H
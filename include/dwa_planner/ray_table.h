@@ -0,0 +1,71 @@
+// Copyright 2020 amsl
+
+/**
+ * @file ray_table.h
+ * @brief Precomputed ray traversals over the local map
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_RAY_TABLE_H
+#define DWA_PLANNER_RAY_TABLE_H
+
+#include <geometry_msgs/PoseArray.h>
+#include <nav_msgs/MapMetaData.h>
+#include <vector>
+
+/**
+ * @class RayTable
+ * @brief The cells crossed by the rays from the robot, rebuilt only when the map geometry changes
+ */
+class RayTable
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  RayTable(void);
+
+  /**
+   * @brief Update the table for the map geometry
+   * @param info The map geometry
+   * @param angle_resolution The angle between two rays
+   * @return True if the table was rebuilt
+   */
+  bool update(const nav_msgs::MapMetaData &info, const double angle_resolution);
+
+  /**
+   * @brief Get the first occupied cell along every ray
+   * @param data The map data
+   * @param num_threads The number of threads the rays are split across
+   * @param obs_list The obstacle list the entry points of the hit cells are written to
+   */
+  void cast(const std::vector<int8_t> &data, const int num_threads, geometry_msgs::PoseArray &obs_list) const;
+
+private:
+  /**
+   * @brief Trace a ray with the DDA traversal and append the cells inside of the map
+   * @param angle The direction of ray
+   */
+  void trace(const double angle);
+
+  /**
+   * @brief Get the first occupied cell along the rays in the range
+   * @param data The map data
+   * @param begin The first ray
+   * @param end The ray after the last one
+   * @param poses The entry points of the hit cells
+   */
+  void cast(const std::vector<int8_t> &data, const int begin, const int end, std::vector<geometry_msgs::Pose> &poses)
+      const;
+
+  nav_msgs::MapMetaData info_;
+  double angle_resolution_;
+  std::vector<float> cos_;
+  std::vector<float> sin_;
+  // the crossed cells of every ray are stored contiguously in the order of traversal
+  std::vector<int> ray_begin_;
+  std::vector<int> cell_;
+  std::vector<float> dist_;
+};
+
+#endif  // DWA_PLANNER_RAY_TABLE_H
@@ -0,0 +1,61 @@
+// Copyright 2020 amsl
+
+/**
+ * @file sampling_grid.h
+ * @brief Evenly spaced samples of a range
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_SAMPLING_GRID_H
+#define DWA_PLANNER_SAMPLING_GRID_H
+
+#include <algorithm>
+#include <cfloat>
+
+/**
+ * @class SamplingGrid
+ * @brief Samples evenly spaced from the minimum to the maximum of a range. A single sample is taken at the centre of
+ * the range.
+ */
+class SamplingGrid
+{
+public:
+  /**
+   * @brief Constructor
+   * @param min The minimum of range
+   * @param max The maximum of range
+   * @param samples The number of samples
+   */
+  SamplingGrid(const double min, const double max, const int samples)
+      : min_(samples <= 1 ? 0.5 * (min + max) : min),
+        resolution_(samples <= 1 ? 0.0 : std::max((max - min) / (samples - 1), DBL_EPSILON)),
+        samples_(std::max(samples, 1))
+  {
+  }
+
+  /**
+   * @brief Get the sample
+   * @param index The index of sample
+   * @return The sample
+   */
+  double sample(const int index) const { return min_ + resolution_ * index; }
+
+  /**
+   * @brief Get the spacing of samples
+   * @return The spacing, 0 if there is a single sample
+   */
+  double resolution(void) const { return resolution_; }
+
+  /**
+   * @brief Get the number of samples
+   * @return The number of samples, at least one
+   */
+  int size(void) const { return samples_; }
+
+private:
+  double min_;
+  double resolution_;
+  int samples_;
+};
+
+#endif  // DWA_PLANNER_SAMPLING_GRID_H
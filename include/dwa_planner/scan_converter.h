@@ -0,0 +1,56 @@
+// Copyright 2020 amsl
+
+/**
+ * @file scan_converter.h
+ * @brief Conversion of laser scans to points with cached trigonometric tables
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_SCAN_CONVERTER_H
+#define DWA_PLANNER_SCAN_CONVERTER_H
+
+#include <cstdint>
+#include <sensor_msgs/LaserScan.h>
+#include <vector>
+
+/**
+ * @class ScanConverter
+ * @brief Converts the ranges of a scan to points, rebuilding the sin/cos tables only when the scan configuration
+ * changes
+ */
+class ScanConverter
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  ScanConverter(void);
+
+  /**
+   * @brief Convert the scan to points in the sensor frame
+   * @param scan The laser scan
+   * @param half_length The half length of the box around the robot checked for points
+   * @param half_width The half width of the box around the robot checked for points
+   * @return True if any beam ends inside of the box
+   */
+  bool convert(const sensor_msgs::LaserScan &scan, const float half_length, const float half_width);
+
+  std::vector<float> x_;
+  std::vector<float> y_;
+  // whether the range of every beam is inside of [range_min, range_max]
+  std::vector<uint8_t> valid_;
+
+private:
+  /**
+   * @brief Rebuild the tables if the scan configuration has changed
+   * @param scan The laser scan
+   */
+  void update_tables(const sensor_msgs::LaserScan &scan);
+
+  float angle_min_;
+  float angle_increment_;
+  std::vector<float> cos_;
+  std::vector<float> sin_;
+};
+
+#endif  // DWA_PLANNER_SCAN_CONVERTER_H
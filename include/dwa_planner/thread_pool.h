@@ -0,0 +1,103 @@
+// Copyright 2020 amsl
+
+/**
+ * @file thread_pool.h
+ * @brief Persistent worker threads running parallel loops
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_THREAD_POOL_H
+#define DWA_PLANNER_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Workers which sleep between loops, so a loop costs no thread creation. The calling thread runs tasks too.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  ThreadPool(void);
+
+  /**
+   * @brief Destructor
+   */
+  ~ThreadPool(void);
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Set the number of threads, must not be called during a loop
+   * @param num_threads The number of threads including the calling thread
+   */
+  void resize(const int num_threads);
+
+  int size(void) const { return workers_.size() + 1; }
+
+  /**
+   * @brief Run the function for every task and wait for all of them. Tasks are taken in any order by any thread, so
+   * the function must only write to what belongs to its task or its thread.
+   * @param num_tasks The number of tasks
+   * @param function The function called with the index of task and the index of thread, less than size()
+   */
+  template <class Function>
+  void run(const int num_tasks, const Function &function)
+  {
+    dispatch(
+        num_tasks, [](const void *context, const int task, const int thread)
+        { (*static_cast<const Function *>(context))(task, thread); },
+        &function);
+  }
+
+private:
+  /**
+   * @brief Run the task function for every task on all threads
+   * @param num_tasks The number of tasks
+   * @param task The function called with the context, the index of task and the index of thread
+   * @param context The context passed to the task function
+   */
+  void dispatch(const int num_tasks, void (*task)(const void *, int, int), const void *context);
+
+  /**
+   * @brief Take tasks until no task is left
+   * @param thread The index of thread
+   */
+  void execute(const int thread);
+
+  /**
+   * @brief The loop of worker thread
+   * @param thread The index of thread
+   * @param generation The generation of loop when the worker is started
+   */
+  void work(const int thread, uint64_t generation);
+
+  /**
+   * @brief Stop and join all workers
+   */
+  void stop(void);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  bool stopped_;
+  // a new loop is signaled by incrementing the generation
+  uint64_t generation_;
+  int busy_workers_;
+  int num_tasks_;
+  std::atomic<int> next_task_;
+  void (*task_)(const void *, int, int);
+  const void *context_;
+};
+
+#endif  // DWA_PLANNER_THREAD_POOL_H
@@ -0,0 +1,78 @@
+// Copyright 2020 amsl
+
+/**
+ * @file trajectory_store.h
+ * @brief Structure of arrays holding the candidate trajectories of a control cycle
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_TRAJECTORY_STORE_H
+#define DWA_PLANNER_TRAJECTORY_STORE_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class TrajectoryStore
+ * @brief Keeps the states, velocities, validity and costs of trajectories in separate arrays. The arrays are only
+ * cleared by reset, so once they have grown to the size of a cycle no more memory is allocated.
+ */
+class TrajectoryStore
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  TrajectoryStore(void);
+
+  /**
+   * @brief Remove all trajectories keeping the memory
+   * @param steps The number of states of every trajectory
+   * @param critic_count The number of costs of the critics loaded as plugins
+   */
+  void reset(const int steps, const int critic_count = 0);
+
+  /**
+   * @brief Add a trajectory, whose states are to be filled by the caller
+   * @param velocity The linear velocity of trajectory
+   * @param yawrate The angular velocity of trajectory
+   * @param lateral_velocity The lateral velocity of trajectory, which is 0 unless the robot is holonomic
+   * @return The index of trajectory, which is invalid and has zero costs
+   */
+  int add(const double velocity, const double yawrate, const double lateral_velocity = 0.0);
+
+  int size(void) const { return velocity_.size(); }
+  int steps(void) const { return steps_; }
+
+  /**
+   * @brief Get the states of trajectory, each array has steps elements
+   * @param index The index of trajectory
+   * @return The array of x positions, y positions or orientations, valid until the next add
+   */
+  float *x(const int index) { return x_.data() + index * steps_; }
+  float *y(const int index) { return y_.data() + index * steps_; }
+  float *yaw(const int index) { return yaw_.data() + index * steps_; }
+  const float *x(const int index) const { return x_.data() + index * steps_; }
+  const float *y(const int index) const { return y_.data() + index * steps_; }
+  const float *yaw(const int index) const { return yaw_.data() + index * steps_; }
+
+  std::vector<double> velocity_;
+  std::vector<double> yawrate_;
+  std::vector<double> lateral_velocity_;
+  std::vector<uint8_t> valid_;
+  std::vector<float> obs_cost_;
+  std::vector<float> to_goal_cost_;
+  std::vector<float> speed_cost_;
+  std::vector<float> path_cost_;
+  std::vector<float> total_cost_;
+  // the costs of each critic loaded as a plugin
+  std::vector<std::vector<float>> critic_costs_;
+
+private:
+  int steps_;
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> yaw_;
+};
+
+#endif  // DWA_PLANNER_TRAJECTORY_STORE_H
@@ -0,0 +1,38 @@
+// Copyright 2020 amsl
+
+/**
+ * @file yawrate_critic.h
+ * @brief An example of a critic loaded as a plugin
+ * @author AMSL
+ */
+
+#ifndef DWA_PLANNER_YAWRATE_CRITIC_H
+#define DWA_PLANNER_YAWRATE_CRITIC_H
+
+#include <ros/ros.h>
+#include "dwa_planner/cost_critic.h"
+#include "dwa_planner/trajectory_store.h"
+
+namespace dwa_planner
+{
+/**
+ * @class YawrateCritic
+ * @brief Scores the turning of trajectories, rejecting the ones turning faster than the maximum yawrate of critic
+ */
+class YawrateCritic : public CostCritic
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  YawrateCritic(void);
+
+  void initialize(const ros::NodeHandle &nh) override;
+  void score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const override;
+
+private:
+  double max_yawrate_;
+};
+}  // namespace dwa_planner
+
+#endif  // DWA_PLANNER_YAWRATE_CRITIC_H
@@ -0,0 +1,57 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <vector>
+
+#include "dwa_planner/arc_table.h"
+#include "dwa_planner/primitive_library.h"
+
+ArcTable::ArcTable(void) : predict_time_(0.0), steps_(0) {}
+
+void ArcTable::reset(const double predict_time, const int steps)
+{
+  predict_time_ = predict_time;
+  steps_ = steps;
+  yawrate_.clear();
+  forward_.clear();
+  leftward_.clear();
+  yaw_.clear();
+}
+
+int ArcTable::add(const double yawrate)
+{
+  // a cycle has a few tens of yawrates, so a linear search is enough
+  const auto it = std::find(yawrate_.begin(), yawrate_.end(), yawrate);
+  if (it != yawrate_.end())
+    return it - yawrate_.begin();
+
+  const int begin = forward_.size();
+  forward_.resize(begin + steps_);
+  leftward_.resize(begin + steps_);
+  yaw_.resize(begin + steps_);
+  rollout_arc(
+      1.0, yawrate, predict_time_, steps_,
+      [&](const int i, const double x, const double y, const double yaw)
+      {
+        forward_[begin + i] = x;
+        leftward_[begin + i] = y;
+        yaw_[begin + i] = yaw;
+      });
+  yawrate_.push_back(yawrate);
+  return yawrate_.size() - 1;
+}
+
+void ArcTable::rollout(
+    const int index, const float velocity, const float lateral_velocity, float *x, float *y, float *yaw) const
+{
+  const float *forward = forward_.data() + index * steps_;
+  const float *leftward = leftward_.data() + index * steps_;
+  const float *arc_yaw = yaw_.data() + index * steps_;
+  // the velocity (vx, vy) rotates the unit arc by atan2(vy, vx) and scales it by the speed
+  for (int i = 0; i < steps_; i++)
+  {
+    x[i] = velocity * forward[i] - lateral_velocity * leftward[i];
+    y[i] = velocity * leftward[i] + lateral_velocity * forward[i];
+    yaw[i] = arc_yaw[i];
+  }
+}
@@ -0,0 +1,83 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dwa_planner/cloud_filter.h"
+
+CloudFilter::CloudFilter(void) : generation_(0) {}
+
+bool CloudFilter::filter(
+    const sensor_msgs::PointCloud2 &cloud, const double min_height, const double max_height, const double max_range,
+    const double voxel_size, geometry_msgs::PoseArray &obs_list)
+{
+  obs_list.poses.clear();
+  const int offset_x = find_float_field(cloud, "x");
+  const int offset_y = find_float_field(cloud, "y");
+  const int offset_z = find_float_field(cloud, "z");
+  if (offset_x < 0 || offset_y < 0 || offset_z < 0 || voxel_size <= 0.0)
+    return false;
+  if (static_cast<size_t>(cloud.width) * cloud.point_step > cloud.row_step ||
+      static_cast<size_t>(cloud.height) * cloud.row_step > cloud.data.size())
+    return false;
+
+  // a square of voxel columns covering the range
+  const int half_cells = static_cast<int>(std::ceil(max_range / voxel_size));
+  const int size = 2 * half_cells + 1;
+  if (stamps_.size() != static_cast<size_t>(size) * size)
+  {
+    stamps_.assign(static_cast<size_t>(size) * size, 0);
+    generation_ = 0;
+  }
+  if (++generation_ == 0)
+  {
+    std::fill(stamps_.begin(), stamps_.end(), 0);
+    generation_ = 1;
+  }
+
+  const float max_range_sq = max_range * max_range;
+  const float inverse_voxel_size = 1.0 / voxel_size;
+  for (uint32_t row = 0; row < cloud.height; row++)
+  {
+    const uint8_t *point = cloud.data.data() + row * cloud.row_step;
+    for (uint32_t col = 0; col < cloud.width; col++, point += cloud.point_step)
+    {
+      float x, y, z;
+      memcpy(&x, point + offset_x, sizeof(float));
+      memcpy(&y, point + offset_y, sizeof(float));
+      memcpy(&z, point + offset_z, sizeof(float));
+      // NaN points fail these comparisons too
+      if (!(min_height <= z && z <= max_height && x * x + y * y <= max_range_sq))
+        continue;
+
+      const int index_x = static_cast<int>(std::floor(x * inverse_voxel_size)) + half_cells;
+      const int index_y = static_cast<int>(std::floor(y * inverse_voxel_size)) + half_cells;
+      if (index_x < 0 || size <= index_x || index_y < 0 || size <= index_y)
+        continue;
+      uint32_t &stamp = stamps_[index_x + index_y * size];
+      if (stamp == generation_)
+        continue;
+      stamp = generation_;
+
+      geometry_msgs::Pose pose;
+      pose.position.x = x;
+      pose.position.y = y;
+      obs_list.poses.push_back(pose);
+    }
+  }
+  return true;
+}
+
+int CloudFilter::find_float_field(const sensor_msgs::PointCloud2 &cloud, const std::string &name) const
+{
+  for (const auto &field : cloud.fields)
+  {
+    if (field.name == name && field.datatype == sensor_msgs::PointField::FLOAT32 &&
+        field.offset + sizeof(float) <= cloud.point_step)
+      return field.offset;
+  }
+  return -1;
+}
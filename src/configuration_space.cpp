@@ -0,0 +1,157 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "dwa_planner/configuration_space.h"
+
+namespace
+{
+/**
+ * @brief Calculate the signed distance from the point to the polygon (negative inside)
+ */
+double calc_signed_distance(const double x, const double y, const std::vector<std::pair<double, double>> &polygon)
+{
+  bool inside = false;
+  double min_dist = DBL_MAX;
+  for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+  {
+    const double ax = polygon[j].first, ay = polygon[j].second;
+    const double bx = polygon[i].first, by = polygon[i].second;
+    if ((by > y) != (ay > y) && x < (ax - bx) * (y - by) / (ay - by) + bx)
+      inside = !inside;
+
+    const double ex = bx - ax, ey = by - ay;
+    const double t = std::min(std::max(((x - ax) * ex + (y - ay) * ey) / (ex * ex + ey * ey + DBL_EPSILON), 0.0), 1.0);
+    min_dist = std::min(min_dist, hypot(x - ax - t * ex, y - ay - t * ey));
+  }
+  return inside ? -min_dist : min_dist;
+}
+}  // namespace
+
+ConfigurationSpace::ConfigurationSpace(void) : resolution_(0.05), yaw_bins_(0) {}
+
+void ConfigurationSpace::set_footprint(
+    const geometry_msgs::Polygon &footprint, const double resolution, const int yaw_bins)
+{
+  std::vector<std::pair<float, float>> vertices;
+  for (const auto &point : footprint.points)
+    vertices.emplace_back(point.x, point.y);
+  if (vertices == footprint_ && resolution == resolution_ && yaw_bins == yaw_bins_)
+    return;
+  footprint_ = vertices;
+  resolution_ = resolution;
+  yaw_bins_ = std::max(yaw_bins, 1);
+
+  double radius = 0.0;
+  for (const auto &vertex : footprint_)
+    radius = std::max(radius, static_cast<double>(hypot(vertex.first, vertex.second)));
+  const double bin_width = 2.0 * M_PI / yaw_bins_;
+  // rotate by sub-steps small enough that no vertex skips a cell inside of a bin
+  const int sub_steps = static_cast<int>(std::ceil(radius * bin_width / resolution_)) + 1;
+  // both the obstacle and the robot are snapped to cells, and the orientations between the sub-steps are not
+  // sampled, so the footprint is inflated by the diagonal of a cell and the sweep of the half width of a bin
+  const double inflation = M_SQRT2 * resolution_ + radius * sin(0.5 * bin_width);
+  const int range = static_cast<int>(std::ceil((radius + inflation) / resolution_)) + 1;
+
+  masks_.assign(yaw_bins_, std::vector<std::pair<int, int>>());
+  for (int bin = 0; bin < yaw_bins_; bin++)
+  {
+    std::vector<std::vector<std::pair<double, double>>> rotated(sub_steps);
+    for (int step = 0; step < sub_steps; step++)
+    {
+      const double yaw = bin_width * (bin - 0.5 + static_cast<double>(step) / std::max(sub_steps - 1, 1));
+      for (const auto &vertex : footprint_)
+        rotated[step].emplace_back(
+            vertex.first * cos(yaw) - vertex.second * sin(yaw), vertex.first * sin(yaw) + vertex.second * cos(yaw));
+    }
+
+    // the robot at the cell (dx, dy) away from an obstacle cell covers it
+    masks_[bin].assign(2 * range + 1, std::make_pair(range + 1, -range - 1));
+    for (int dy = -range; dy <= range; dy++)
+    {
+      auto &span = masks_[bin][dy + range];
+      for (int dx = -range; dx <= range; dx++)
+      {
+        for (const auto &polygon : rotated)
+        {
+          if (calc_signed_distance(-dx * resolution_, -dy * resolution_, polygon) <= inflation)
+          {
+            span.first = std::min(span.first, dx);
+            span.second = std::max(span.second, dx);
+            break;
+          }
+        }
+      }
+    }
+  }
+  clearance_.resize(yaw_bins_);
+}
+
+void ConfigurationSpace::reset(const double half_size)
+{
+  field_.reset(resolution_, half_size);
+  obstacle_cells_.clear();
+}
+
+void ConfigurationSpace::add_obstacle(const double x, const double y)
+{
+  const int index = field_.to_index(x, y);
+  if (0 <= index)
+    obstacle_cells_.emplace_back(index % field_.size_, index / field_.size_);
+}
+
+void ConfigurationSpace::compute(void)
+{
+  std::sort(obstacle_cells_.begin(), obstacle_cells_.end());
+  obstacle_cells_.erase(std::unique(obstacle_cells_.begin(), obstacle_cells_.end()), obstacle_cells_.end());
+
+  const int size = field_.size_;
+  for (int bin = 0; bin < yaw_bins_; bin++)
+  {
+    occupied_.assign(static_cast<size_t>(size) * size, 0);
+    for (const auto &cell : obstacle_cells_)
+    {
+      const int range = masks_[bin].size() / 2;
+      for (int dy = -range; dy <= range; dy++)
+      {
+        const int index_y = cell.second + dy;
+        const auto &span = masks_[bin][dy + range];
+        if (index_y < 0 || size <= index_y || span.second < span.first)
+          continue;
+        const int begin = std::max(cell.first + span.first, 0);
+        const int end = std::min(cell.first + span.second + 1, size);
+        if (begin < end)
+          std::fill(occupied_.begin() + index_y * size + begin, occupied_.begin() + index_y * size + end, 1);
+      }
+    }
+    field_.compute(occupied_, clearance_[bin]);
+    // distance to the edge of the nearest occupied cell rather than to its center
+    for (auto &clearance : clearance_[bin])
+      clearance = std::max(clearance - 0.5f * static_cast<float>(resolution_), 0.0f);
+  }
+}
+
+bool ConfigurationSpace::contains(const double x, const double y) const
+{
+  return !clearance_.empty() && field_.contains(x, y);
+}
+
+bool ConfigurationSpace::is_colliding(const double x, const double y, const double yaw) const
+{
+  return distance(x, y, yaw) <= 0.0;
+}
+
+float ConfigurationSpace::distance(const double x, const double y, const double yaw) const
+{
+  return clearance_[to_bin(yaw)][field_.to_index(x, y)];
+}
+
+int ConfigurationSpace::to_bin(const double yaw) const
+{
+  const int bin = static_cast<int>(std::lround(yaw / (2.0 * M_PI / yaw_bins_))) % yaw_bins_;
+  return bin < 0 ? bin + yaw_bins_ : bin;
+}
@@ -0,0 +1,100 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "dwa_planner/convex_polygon.h"
+
+namespace
+{
+/**
+ * @brief Calculate the z component of the cross product of (a - o) and (b - o)
+ */
+double cross(const Eigen::Vector2d &o, const Eigen::Vector2d &a, const Eigen::Vector2d &b)
+{
+  return (a.x() - o.x()) * (b.y() - o.y()) - (a.y() - o.y()) * (b.x() - o.x());
+}
+
+/**
+ * @brief Calculate the distance from the point to the segment
+ */
+double calc_dist_to_segment(const Eigen::Vector2d &point, const Eigen::Vector2d &a, const Eigen::Vector2d &b)
+{
+  const Eigen::Vector2d edge = b - a;
+  const double length_sq = edge.squaredNorm();
+  const double t = length_sq < DBL_EPSILON ? 0.0 : std::min(std::max((point - a).dot(edge) / length_sq, 0.0), 1.0);
+  return (point - a - t * edge).norm();
+}
+}  // namespace
+
+void calc_convex_hull(std::vector<Eigen::Vector2d> &points)
+{
+  if (points.size() < 3)
+    return;
+  std::sort(
+      points.begin(), points.end(), [](const Eigen::Vector2d &a, const Eigen::Vector2d &b)
+      { return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y()); });
+
+  // monotone chain, the lower hull and then the upper hull
+  std::vector<Eigen::Vector2d> hull(2 * points.size());
+  int k = 0;
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    while (2 <= k && cross(hull[k - 2], hull[k - 1], points[i]) <= 0)
+      k--;
+    hull[k++] = points[i];
+  }
+  for (int i = static_cast<int>(points.size()) - 2, lower = k + 1; 0 <= i; i--)
+  {
+    while (lower <= k && cross(hull[k - 2], hull[k - 1], points[i]) <= 0)
+      k--;
+    hull[k++] = points[i];
+  }
+  hull.resize(k - 1);
+  points = hull;
+}
+
+bool is_inside_of_convex_polygon(
+    const Eigen::Vector2d &point, const std::vector<Eigen::Vector2d> &vertices,
+    const std::vector<Eigen::Vector2d> &edge_normals)
+{
+  if (vertices.size() < 3)
+    return false;
+  // inside if the point is behind every edge
+  for (size_t i = 0; i < vertices.size(); i++)
+  {
+    if (0.0 < edge_normals[i].dot(point - vertices[i]))
+      return false;
+  }
+  return true;
+}
+
+double calc_signed_distance_to_convex_polygon(
+    const Eigen::Vector2d &point, const std::vector<Eigen::Vector2d> &vertices,
+    const std::vector<Eigen::Vector2d> &edge_normals)
+{
+  if (vertices.empty())
+    return DBL_MAX;
+  if (vertices.size() < 3)
+  {
+    double min_dist = (point - vertices.front()).norm();
+    for (size_t i = 0; i < vertices.size(); i++)
+      min_dist = std::min(min_dist, calc_dist_to_segment(point, vertices[i], vertices[(i + 1) % vertices.size()]));
+    return min_dist;
+  }
+
+  // the nearest point outside of the polygon lies on an edge the point is in front of
+  double max_separation = -DBL_MAX;
+  double min_dist = DBL_MAX;
+  for (size_t i = 0; i < vertices.size(); i++)
+  {
+    const double separation = edge_normals[i].dot(point - vertices[i]);
+    max_separation = std::max(max_separation, separation);
+    if (0.0 < separation)
+      min_dist = std::min(min_dist, calc_dist_to_segment(point, vertices[i], vertices[(i + 1) % vertices.size()]));
+  }
+  // inside, the nearest edge is the one with the largest separation
+  return max_separation <= 0.0 ? max_separation : min_dist;
+}
@@ -0,0 +1,210 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "dwa_planner/critics.h"
+#include "dwa_planner/min_distance.h"
+
+ObstacleCritic::ObstacleCritic(void)
+    : obstacles_(nullptr), obs_range_(0.0), robot_radius_(0.0), footprint_padding_(0.0), use_footprint_(false),
+      use_distance_field_(false)
+{
+}
+
+void ObstacleCritic::configure(
+    const double obs_range, const double robot_radius, const double footprint_padding, const bool use_footprint,
+    const bool use_distance_field)
+{
+  obs_range_ = obs_range;
+  robot_radius_ = robot_radius;
+  footprint_padding_ = footprint_padding;
+  use_footprint_ = use_footprint;
+  use_distance_field_ = use_distance_field;
+}
+
+void ObstacleCritic::prepare(const dwa_planner::CriticContext &context) { obstacles_ = context.obstacle_snapshot_; }
+
+void ObstacleCritic::score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const
+{
+  for (int i = 0; i < count; i++)
+    costs[indices[i]] = calc_cost(trajectories, indices[i]);
+}
+
+float ObstacleCritic::calc_cost(const TrajectoryStore &trajectories, const int index) const
+{
+  if (!use_footprint_ && !use_distance_field_)
+    return calc_circle_cost(trajectories, index);
+
+  const ObstacleIndex &obs_index = obstacles_->obs_index_;
+  const DistanceField &distance_field = obstacles_->distance_field_;
+  const ConfigurationSpace &configuration_space = obstacles_->configuration_space_;
+  const Footprint &footprint = *obstacles_->footprint_;
+  const int steps = trajectories.steps();
+  const float *traj_x = trajectories.x(index);
+  const float *traj_y = trajectories.y(index);
+  const float *traj_yaw = trajectories.yaw(index);
+  // the field may overestimate the distance by up to about the diagonal of a cell, which is subtracted so that contacts
+  // are not missed
+  const float field_inflation = robot_radius_ + footprint_padding_ + M_SQRT2 * distance_field.resolution_;
+  float min_dist = obs_range_;
+  for (int step = 0; step < steps; step++)
+  {
+    const double x = traj_x[step];
+    const double y = traj_y[step];
+    const double yaw = traj_yaw[step];
+    if (use_distance_field_)
+    {
+      if (use_footprint_ ? configuration_space.contains(x, y) : distance_field.contains(x, y))
+      {
+        const float dist = use_footprint_ ? configuration_space.distance(x, y, yaw)
+                                        : distance_field.distance(x, y) - field_inflation;
+        if (dist < DBL_EPSILON)
+          return INFEASIBLE_COST;
+        min_dist = std::min(min_dist, dist);
+        continue;
+      }
+    }
+    if (use_footprint_)
+    {
+      // obstacles farther than this from the center cannot be nearer to the footprint than min_dist
+      const Eigen::Isometry2d to_robot = (Eigen::Translation2d(x, y) * Eigen::Rotation2Dd(yaw)).inverse();
+      const bool is_colliding = obs_index.search_radius(
+          x, y, min_dist + footprint.radius_,
+          [&](const int i)
+          {
+            const float dist = calc_dist_from_robot(obstacles_->obs_list_.poses[i].position, to_robot, footprint);
+            min_dist = std::min(min_dist, dist);
+            return dist < DBL_EPSILON;
+          });
+      if (is_colliding)
+        return INFEASIBLE_COST;
+    }
+    else
+    {
+      const float inflation = robot_radius_ + footprint_padding_;
+      const float center_dist = obs_index.nearest_distance(x, y, min_dist + inflation);
+      if (center_dist == FLT_MAX)
+        continue;
+      const float dist = center_dist - inflation;
+      if (dist < DBL_EPSILON)
+        return INFEASIBLE_COST;
+      min_dist = std::min(min_dist, dist);
+    }
+  }
+  return obs_range_ - min_dist;
+}
+
+float ObstacleCritic::calc_circle_cost(const TrajectoryStore &trajectories, const int index) const
+{
+  const ObstacleIndex &obs_index = obstacles_->obs_index_;
+  const float inflation = robot_radius_ + footprint_padding_;
+  const float *traj_x = trajectories.x(index);
+  const float *traj_y = trajectories.y(index);
+  const int steps = trajectories.steps();
+  float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+  for (int i = 0; i < steps; i++)
+  {
+    min_x = std::min(min_x, traj_x[i]);
+    min_y = std::min(min_y, traj_y[i]);
+    max_x = std::max(max_x, traj_x[i]);
+    max_y = std::max(max_y, traj_y[i]);
+  }
+
+  // obstacles farther than this from every state never lower the cost
+  const float reach = obs_range_ + inflation;
+  const float collision_dist = inflation + DBL_EPSILON;
+  float min_sq_dist = reach * reach;
+  obs_index.search_box(
+      min_x - reach, min_y - reach, max_x + reach, max_y + reach,
+      [&](const int begin, const int end)
+      {
+        return calc_min_squared_distance(
+            traj_x, traj_y, steps, obs_index.x_.data() + begin, obs_index.y_.data() + begin, end - begin,
+            collision_dist * collision_dist, min_sq_dist);
+      });
+
+  const float dist = std::sqrt(min_sq_dist) - inflation;
+  if (dist < DBL_EPSILON)
+    return INFEASIBLE_COST;
+  return obs_range_ - std::min(static_cast<float>(obs_range_), dist);
+}
+
+float ObstacleCritic::calc_dist_from_robot(
+    const geometry_msgs::Point &obstacle, const Eigen::Isometry2d &to_robot, const Footprint &footprint) const
+{
+  return std::max(footprint.signed_distance(to_robot * Eigen::Vector2d(obstacle.x, obstacle.y)), 0.0);
+}
+
+ToGoalCritic::ToGoalCritic(void) : goal_(Eigen::Vector3d::Zero()) {}
+
+void ToGoalCritic::prepare(const dwa_planner::CriticContext &context) { goal_ = context.goal_; }
+
+void ToGoalCritic::score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const
+{
+  const int last = trajectories.steps() - 1;
+  for (int i = 0; i < count; i++)
+  {
+    const int index = indices[i];
+    Eigen::Vector3d last_position(
+        trajectories.x(index)[last], trajectories.y(index)[last], trajectories.yaw(index)[last]);
+    costs[index] = (last_position.segment(0, 2) - goal_.segment(0, 2)).norm();
+  }
+}
+
+SpeedCritic::SpeedCritic(void) : max_velocity_(0.0), use_holonomic_(false) {}
+
+void SpeedCritic::prepare(const dwa_planner::CriticContext &context)
+{
+  max_velocity_ = context.max_velocity_;
+  use_holonomic_ = context.use_holonomic_;
+}
+
+void SpeedCritic::score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const
+{
+  if (use_holonomic_)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      const int index = indices[i];
+      costs[index] = max_velocity_ - hypot(trajectories.velocity_[index], trajectories.lateral_velocity_[index]);
+    }
+    return;
+  }
+  for (int i = 0; i < count; i++)
+    costs[indices[i]] = max_velocity_ - trajectories.velocity_[indices[i]];
+}
+
+PathCritic::PathCritic(void) : path_distance_(nullptr), robot_to_global_(Eigen::Isometry2d::Identity()) {}
+
+void PathCritic::prepare(const dwa_planner::CriticContext &context)
+{
+  path_distance_ = context.path_distance_;
+  robot_to_global_ = context.robot_to_global_;
+}
+
+void PathCritic::score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const
+{
+  const int steps = trajectories.steps();
+  for (int i = 0; i < count; i++)
+  {
+    const int index = indices[i];
+    if (path_distance_ == nullptr || path_distance_->empty())
+    {
+      costs[index] = 0.0;
+      continue;
+    }
+    // the distance integrated over the trajectory, divided by the predict time to keep it in meters
+    const float *x = trajectories.x(index);
+    const float *y = trajectories.y(index);
+    float sum = 0.0;
+    for (int step = 0; step < steps; step++)
+    {
+      // the distance grid is in the global frame, so it is not rebuilt as the robot moves
+      const Eigen::Vector2d position = robot_to_global_ * Eigen::Vector2d(x[step], y[step]);
+      sum += path_distance_->distance(position.x(), position.y());
+    }
+    costs[index] = sum / steps;
+  }
+}
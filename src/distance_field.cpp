@@ -0,0 +1,197 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "dwa_planner/distance_field.h"
+
+DistanceField::DistanceField(void) : resolution_(0.05), origin_(0.0), size_(0) {}
+
+void DistanceField::reset(const double resolution, const double half_size)
+{
+  resolution_ = resolution;
+  size_ = std::max(static_cast<int>(std::ceil(2.0 * half_size / resolution_)), 1);
+  origin_ = -0.5 * size_ * resolution_;
+
+  const size_t cells = static_cast<size_t>(size_) * size_;
+  obstacle_x_.clear();
+  obstacle_y_.clear();
+  obstacle_cell_.clear();
+  cell_begin_.assign(cells + 1, 0);
+  nearest_cell_.resize(cells);
+  row_dist_.resize(cells);
+  row_arg_.resize(cells);
+  f_.resize(size_);
+  d_.resize(size_);
+  arg_.resize(size_);
+  v_.resize(size_);
+  z_.resize(size_ + 1);
+}
+
+bool DistanceField::add_obstacle(const double x, const double y)
+{
+  const int index = to_index(x, y);
+  if (index < 0)
+    return false;
+  obstacle_x_.push_back(x);
+  obstacle_y_.push_back(y);
+  obstacle_cell_.push_back(index);
+  cell_begin_[index + 1]++;
+  return true;
+}
+
+void DistanceField::compute(void)
+{
+  // bucket the obstacles by cell
+  for (size_t i = 1; i < cell_begin_.size(); i++)
+    cell_begin_[i] += cell_begin_[i - 1];
+  sorted_x_.resize(obstacle_x_.size());
+  sorted_y_.resize(obstacle_y_.size());
+  for (size_t i = 0; i < obstacle_cell_.size(); i++)
+  {
+    const int slot = cell_begin_[obstacle_cell_[i]]++;
+    sorted_x_[slot] = obstacle_x_[i];
+    sorted_y_[slot] = obstacle_y_[i];
+  }
+  for (size_t i = cell_begin_.size() - 1; 0 < i; i--)
+    cell_begin_[i] = cell_begin_[i - 1];
+  cell_begin_[0] = 0;
+
+  // rows: the nearest obstacle column of each cell
+  for (int iy = 0; iy < size_; iy++)
+  {
+    const int offset = iy * size_;
+    for (int ix = 0; ix < size_; ix++)
+      f_[ix] = cell_begin_[offset + ix] < cell_begin_[offset + ix + 1] ? 0.0 : FLT_MAX;
+    transform_1d(f_.data(), size_, &row_dist_[offset], &row_arg_[offset]);
+  }
+
+  // columns: combine with the row results to get the nearest obstacle cell
+  for (int ix = 0; ix < size_; ix++)
+  {
+    for (int iy = 0; iy < size_; iy++)
+      f_[iy] = row_dist_[iy * size_ + ix];
+    transform_1d(f_.data(), size_, d_.data(), arg_.data());
+    for (int iy = 0; iy < size_; iy++)
+    {
+      if (d_[iy] == FLT_MAX)
+        nearest_cell_[iy * size_ + ix] = -1;
+      else
+        nearest_cell_[iy * size_ + ix] = arg_[iy] * size_ + row_arg_[arg_[iy] * size_ + ix];
+    }
+  }
+}
+
+void DistanceField::compute(const std::vector<uint8_t> &occupied, std::vector<float> &dist)
+{
+  dist.resize(occupied.size());
+  // columns: a binary image only needs the nearest occupied cell on each side, swept row by row
+  std::vector<int> &last = arg_;
+  std::fill(last.begin(), last.end(), -size_ * size_);
+  for (int iy = 0; iy < size_; iy++)
+  {
+    const int offset = iy * size_;
+    for (int ix = 0; ix < size_; ix++)
+    {
+      if (occupied[offset + ix])
+        last[ix] = iy;
+      row_arg_[offset + ix] = iy - last[ix];
+    }
+  }
+  std::fill(last.begin(), last.end(), size_ * size_);
+  for (int iy = size_ - 1; 0 <= iy; iy--)
+  {
+    const int offset = iy * size_;
+    for (int ix = 0; ix < size_; ix++)
+    {
+      if (occupied[offset + ix])
+        last[ix] = iy;
+      const int gap = std::min(row_arg_[offset + ix], last[ix] - iy);
+      row_dist_[offset + ix] = gap < size_ ? static_cast<float>(gap * gap) : FLT_MAX;
+    }
+  }
+
+  // rows
+  for (int iy = 0; iy < size_; iy++)
+  {
+    const int offset = iy * size_;
+    transform_1d(&row_dist_[offset], size_, d_.data(), arg_.data());
+    for (int ix = 0; ix < size_; ix++)
+      dist[offset + ix] = d_[ix] == FLT_MAX ? FLT_MAX : std::sqrt(d_[ix]) * resolution_;
+  }
+}
+
+bool DistanceField::contains(const double x, const double y) const { return 0 <= to_index(x, y); }
+
+float DistanceField::distance(const double x, const double y) const
+{
+  // the nearest obstacles of the neighboring cells make up for the discretization of the query position
+  const int index_x = floor((x - origin_) / resolution_);
+  const int index_y = floor((y - origin_) / resolution_);
+  float min_dist = FLT_MAX;
+  for (int iy = std::max(index_y - 1, 0); iy <= std::min(index_y + 1, size_ - 1); iy++)
+  {
+    for (int ix = std::max(index_x - 1, 0); ix <= std::min(index_x + 1, size_ - 1); ix++)
+    {
+      const int nearest = nearest_cell_[ix + iy * size_];
+      if (nearest < 0)
+        continue;
+      for (int i = cell_begin_[nearest]; i < cell_begin_[nearest + 1]; i++)
+        min_dist = std::min(min_dist, static_cast<float>(hypot(x - sorted_x_[i], y - sorted_y_[i])));
+    }
+  }
+  return min_dist;
+}
+
+void DistanceField::transform_1d(const float *f, const int n, float *d, int *arg)
+{
+  int *v = v_.data();
+  float *z = z_.data();
+  int k = -1;
+  for (int q = 0; q < n; q++)
+  {
+    if (f[q] == FLT_MAX)
+      continue;
+    const float fq = f[q] + static_cast<float>(q * q);
+    float s = -FLT_MAX;
+    while (0 <= k)
+    {
+      s = (fq - (f[v[k]] + static_cast<float>(v[k] * v[k]))) / static_cast<float>(2 * (q - v[k]));
+      if (s <= z[k])
+        k--;
+      else
+        break;
+    }
+    k++;
+    v[k] = q;
+    z[k] = k == 0 ? -FLT_MAX : s;
+    z[k + 1] = FLT_MAX;
+  }
+
+  if (k < 0)
+  {
+    std::fill(d, d + n, FLT_MAX);
+    std::fill(arg, arg + n, -1);
+    return;
+  }
+
+  k = 0;
+  for (int q = 0; q < n; q++)
+  {
+    while (z[k + 1] < q)
+      k++;
+    d[q] = static_cast<float>((q - v[k]) * (q - v[k])) + f[v[k]];
+    arg[q] = v[k];
+  }
+}
+
+int DistanceField::to_index(const double x, const double y) const
+{
+  const int index_x = floor((x - origin_) / resolution_);
+  const int index_y = floor((y - origin_) / resolution_);
+  if (index_x < 0 || size_ <= index_x || index_y < 0 || size_ <= index_y)
+    return -1;
+  return index_x + index_y * size_;
+}
@@ -1,6 +1,8 @@
 // Copyright 2020 amsl
 
 #include <algorithm>
+#include <cfloat>
+#include <chrono>
 #include <string>
 #include <utility>
 #include <vector>
@@ -8,50 +10,83 @@
 #include "dwa_planner/dwa_planner.h"
 
 DWAPlanner::DWAPlanner(void)
-    : local_nh_("~"), odom_updated_(false), local_map_updated_(false), scan_updated_(false), has_reached_(false),
-      use_speed_cost_(false), odom_not_subscribe_count_(0), local_map_not_subscribe_count_(0),
-      scan_not_subscribe_count_(0)
+    : primitive_predict_time_(0.0), use_speed_cost_(false), has_reached_(false), primitive_sim_time_samples_(0),
+      odom_received_time_(ros::Time::now().toSec()), local_map_received_time_(odom_received_time_),
+      scan_received_time_(odom_received_time_), cloud_received_time_(odom_received_time_), local_nh_("~"),
+      tf_listener_(tf_buffer_), edge_on_global_path_filter_(tf_buffer_, "", 1, nh_),
+      goal_filter_(tf_buffer_, "", 1, nh_), sensor_spinner_(1, &sensor_queue_), has_new_obstacles_(false),
+      last_velocity_(0.0), last_yawrate_(0.0), last_lateral_velocity_(0.0), deadline_hit_(false),
+      deadline_hit_count_(0), footprint_cache_(std::make_shared<Footprint>()),
+      critic_loader_("dwa_planner", "dwa_planner::CostCritic"), global_to_robot_(Eigen::Isometry2d::Identity()),
+      in_collision_(false)
 {
   load_params();
 
   ROS_INFO("=== DWA Planner ===");
   print_params();
 
+  evaluation_pool_.resize(evaluation_threads_);
+  thread_trajectories_.resize(evaluation_pool_.size());
+  obstacle_critic_.configure(obs_range_, robot_radius_, footprint_padding_, use_footprint_, use_distance_field_);
+  load_critics();
+  if (!primitive_library_path_.empty())
+    load_primitive_library();
+
   velocity_pub_ = nh_.advertise<geometry_msgs::Twist>("/cmd_vel", 1);
   candidate_trajectories_pub_ = local_nh_.advertise<visualization_msgs::MarkerArray>("candidate_trajectories", 1);
   selected_trajectory_pub_ = local_nh_.advertise<visualization_msgs::Marker>("selected_trajectory", 1);
   predict_footprints_pub_ = local_nh_.advertise<visualization_msgs::MarkerArray>("predict_footprints", 1);
   finish_flag_pub_ = local_nh_.advertise<std_msgs::Bool>("finish_flag", 1);
+  deadline_hits_pub_ = local_nh_.advertise<std_msgs::Int32>("deadline_hits", 1);
   weights_pub = local_nh_.advertise<traj_planner::Weights>("/using_weights", 1);
 
+  // a single spinner thread keeps the sensor callbacks serialized with each other
+  ros::NodeHandle sensor_nh;
+  if (use_sensor_thread_)
+    sensor_nh.setCallbackQueue(&sensor_queue_);
+  cloud_sub_ = sensor_nh.subscribe("/cloud", 1, &DWAPlanner::cloud_callback, this);
   dist_to_goal_th_sub_ = nh_.subscribe("/dist_to_goal_th", 1, &DWAPlanner::dist_to_goal_th_callback, this);
-  edge_on_global_path_sub_ = nh_.subscribe("/path", 1, &DWAPlanner::edge_on_global_path_callback, this);
+  edge_on_global_path_sub_.subscribe(nh_, "/path", 1);
+  edge_on_global_path_filter_.connectInput(edge_on_global_path_sub_);
+  edge_on_global_path_filter_.setTargetFrame(global_frame_);
+  edge_on_global_path_filter_.registerCallback(&DWAPlanner::edge_on_global_path_callback, this);
   footprint_sub_ = nh_.subscribe("/footprint", 1, &DWAPlanner::footprint_callback, this);
-  goal_sub_ = nh_.subscribe("/move_base_simple/goal", 1, &DWAPlanner::goal_callback, this);
-  local_map_sub_ = nh_.subscribe("/local_map", 1, &DWAPlanner::local_map_callback, this);
+  goal_sub_.subscribe(nh_, "/move_base_simple/goal", 1);
+  goal_filter_.connectInput(goal_sub_);
+  goal_filter_.setTargetFrame(global_frame_);
+  goal_filter_.registerCallback(&DWAPlanner::goal_callback, this);
+  local_map_sub_ = sensor_nh.subscribe("/local_map", 1, &DWAPlanner::local_map_callback, this);
   odom_sub_ = nh_.subscribe("/odom", 1, &DWAPlanner::odom_callback, this);
-  scan_sub_ = nh_.subscribe("/scan", 1, &DWAPlanner::scan_callback, this);
+  scan_sub_ = sensor_nh.subscribe("/scan", 1, &DWAPlanner::scan_callback, this);
   target_velocity_sub_ = nh_.subscribe("/target_velocity", 1, &DWAPlanner::target_velocity_callback, this);
   weights_sub = nh_.subscribe("/set_weights", 1, &DWAPlanner::weightsCallback, this);
 
   if (!use_footprint_)
+  {
     footprint_ = geometry_msgs::PolygonStamped();
+    auto footprint = std::make_shared<Footprint>();
+    footprint->update(robot_radius_, footprint_padding_);
+    footprint_cache_ = std::move(footprint);
+  }
+  auto snapshot = std::make_shared<ObstacleSnapshot>();
+  snapshot->footprint_ = footprint_cache_;
+  obstacle_snapshot_ = std::move(snapshot);
   if (!use_path_cost_)
-    edge_points_on_path_ = nav_msgs::Path();
-  if (!use_scan_as_input_)
-    scan_updated_ = true;
-  else
-    local_map_updated_ = true;
+    edge_points_on_path_ = Eigen::Matrix2Xd();
 }
 
-DWAPlanner::State::State(void) : x_(0.0), y_(0.0), yaw_(0.0), velocity_(0.0), yawrate_(0.0) {}
+DWAPlanner::State::State(void) : x_(0.0), y_(0.0), yaw_(0.0), velocity_(0.0), yawrate_(0.0), lateral_velocity_(0.0) {}
 
 DWAPlanner::State::State(const double x, const double y, const double yaw, const double velocity, const double yawrate)
-    : x_(x), y_(y), yaw_(yaw), velocity_(velocity), yawrate_(yawrate)
+    : x_(x), y_(y), yaw_(yaw), velocity_(velocity), yawrate_(yawrate), lateral_velocity_(0.0)
 {
 }
 
-DWAPlanner::Window::Window(void) : min_velocity_(0.0), max_velocity_(0.0), min_yawrate_(0.0), max_yawrate_(0.0) {}
+DWAPlanner::Window::Window(void)
+    : min_velocity_(0.0), max_velocity_(0.0), min_yawrate_(0.0), max_yawrate_(0.0), min_lateral_velocity_(0.0),
+      max_lateral_velocity_(0.0)
+{
+}
 
 void DWAPlanner::Window::show(void)
 {
@@ -62,9 +97,13 @@ void DWAPlanner::Window::show(void)
   ROS_INFO_STREAM("\tYawrate:");
   ROS_INFO_STREAM("\t\tmax: " << max_yawrate_);
   ROS_INFO_STREAM("\t\tmin: " << min_yawrate_);
+  ROS_INFO_STREAM("\tLateral velocity:");
+  ROS_INFO_STREAM("\t\tmax: " << max_lateral_velocity_);
+  ROS_INFO_STREAM("\t\tmin: " << min_lateral_velocity_);
 }
 
-DWAPlanner::Cost::Cost(void) : obs_cost_(0.0), to_goal_cost_(0.0), speed_cost_(0.0), path_cost_(0.0), total_cost_(0.0)
+DWAPlanner::Cost::Cost(void)
+    : obs_cost_(0.0), to_goal_cost_(0.0), speed_cost_(0.0), path_cost_(0.0), critic_cost_(0.0), total_cost_(0.0)
 {
 }
 
@@ -72,7 +111,7 @@ DWAPlanner::Cost::Cost(
     const float obs_cost, const float to_goal_cost, const float speed_cost, const float path_cost,
     const float total_cost)
     : obs_cost_(obs_cost), to_goal_cost_(to_goal_cost), speed_cost_(speed_cost), path_cost_(path_cost),
-      total_cost_(total_cost)
+      critic_cost_(0.0), total_cost_(total_cost)
 {
 }
 
@@ -83,70 +122,71 @@ void DWAPlanner::Cost::show(void)
   ROS_INFO_STREAM("\tGoal cost: " << to_goal_cost_);
   ROS_INFO_STREAM("\tSpeed cost: " << speed_cost_);
   ROS_INFO_STREAM("\tPath cost: " << path_cost_);
+  ROS_INFO_STREAM("\tCritic cost: " << critic_cost_);
 }
 
-void DWAPlanner::Cost::calc_total_cost(void) { total_cost_ = obs_cost_ + to_goal_cost_ + speed_cost_ + path_cost_; }
+void DWAPlanner::Cost::calc_total_cost(void)
+{
+  total_cost_ = obs_cost_ + to_goal_cost_ + speed_cost_ + path_cost_ + critic_cost_;
+}
 
 void DWAPlanner::goal_callback(const geometry_msgs::PoseStampedConstPtr &msg)
 {
-  goal_msg_ = *msg;
-  if (goal_msg_.value().header.frame_id != global_frame_)
+  // the message filter passes the goal once its transform to the global frame is available
+  geometry_msgs::PoseStamped goal;
+  try
   {
-    try
-    {
-      listener_.transformPose(
-          global_frame_, ros::Time(0), goal_msg_.value(), goal_msg_.value().header.frame_id, goal_msg_.value());
-      ROS_INFO("GOTTON GOAL!");
-    }
-    catch (tf::TransformException ex)
-    {
-      ROS_ERROR("%s", ex.what());
-    }
+    tf_buffer_.transform(*msg, goal, global_frame_);
+  }
+  catch (const tf2::TransformException &ex)
+  {
+    ROS_ERROR("%s", ex.what());
+    return;
   }
+  goal_msg_ = goal;
 }
 
 void DWAPlanner::scan_callback(const sensor_msgs::LaserScanConstPtr &msg)
 {
-  if (use_scan_as_input_)
-    create_obs_list(*msg);
-  scan_not_subscribe_count_ = 0;
-  scan_updated_ = true;
-
-  int i;
-  double lsr_len=msg->ranges.size();
-  double lsr_angle_inc=msg->angle_increment;
-  double lsr_angle_min=msg->angle_min;
-  bool collision = false;
-  for (i=0;i<(lsr_len-1);i++){
-    double angle=((double)(i)*lsr_angle_inc)+lsr_angle_min;
-
-    double x = msg->ranges[i] * cos(angle);
-    double y = msg->ranges[i] * sin(angle);
-
-    double half_width = 0.6 / 2.0;
-    double half_length = 0.85 / 2.0;
-
-    // Check if the point (x, y) lies within the UGV's bounding box
-    if (x >= -half_length && x <= half_length && y >= -half_width && y <= half_width) {
-        collision = true;
-    }
+  // check if any beam ends inside of the bounding box of the UGV
+  const float half_length = 0.85 / 2.0;
+  const float half_width = 0.6 / 2.0;
+  in_collision_ = scan_converter_.convert(*msg, half_length, half_width);
+  if (use_scan_as_input_ && !use_cloud_as_input_)
+  {
+    ObstacleSnapshot &snapshot = acquire_obstacle_buffer();
+    create_obs_list(*msg, snapshot.obs_list_);
+    publish_obstacle_buffer();
   }
-  in_collision_ = collision;  
+  scan_received_time_ = ros::Time::now().toSec();
 }
 
 void DWAPlanner::local_map_callback(const nav_msgs::OccupancyGridConstPtr &msg)
 {
-  if (!use_scan_as_input_)
-    create_obs_list(*msg);
-  local_map_not_subscribe_count_ = 0;
-  local_map_updated_ = true;
+  if (!use_scan_as_input_ && !use_cloud_as_input_)
+  {
+    ObstacleSnapshot &snapshot = acquire_obstacle_buffer();
+    create_obs_list(*msg, snapshot.obs_list_);
+    publish_obstacle_buffer();
+  }
+  local_map_received_time_ = ros::Time::now().toSec();
+}
+
+void DWAPlanner::cloud_callback(const sensor_msgs::PointCloud2ConstPtr &msg)
+{
+  if (use_cloud_as_input_)
+  {
+    ObstacleSnapshot &snapshot = acquire_obstacle_buffer();
+    create_obs_list(*msg, snapshot.obs_list_);
+    publish_obstacle_buffer();
+  }
+  cloud_received_time_ = ros::Time::now().toSec();
 }
 
 void DWAPlanner::odom_callback(const nav_msgs::OdometryConstPtr &msg)
 {
   current_cmd_vel_ = msg->twist.twist;
-  odom_not_subscribe_count_ = 0;
-  odom_updated_ = true;
+  odom_received_time_ = ros::Time::now().toSec();
 }
 
 void DWAPlanner::weightsCallback(const traj_planner::WeightsConstPtr &msg)
@@ -166,11 +206,10 @@ void DWAPlanner::target_velocity_callback(const geometry_msgs::TwistConstPtr &ms
 void DWAPlanner::footprint_callback(const geometry_msgs::PolygonStampedPtr &msg)
 {
   footprint_ = *msg;
-  for (auto &point : footprint_.value().polygon.points)
-  {
-    point.x += point.x < 0 ? -footprint_padding_ : footprint_padding_;
-    point.y += point.y < 0 ? -footprint_padding_ : footprint_padding_;
-  }
+  // the footprint is rebuilt on a copy, as the sensor callbacks may be reading the current one
+  auto footprint = std::make_shared<Footprint>(*footprint_cache_);
+  if (footprint->update(msg->polygon, footprint_padding_))
+    std::atomic_store(&footprint_cache_, std::shared_ptr<const Footprint>(std::move(footprint)));
 }
 
 void DWAPlanner::dist_to_goal_th_callback(const std_msgs::Float64ConstPtr &msg)
@@ -183,163 +222,522 @@ void DWAPlanner::edge_on_global_path_callback(const nav_msgs::PathConstPtr &msg)
 {
   if (!use_path_cost_)
     return;
-  edge_points_on_path_ = *msg;
+  // every pose of the path has the same stamp and frame, so one lookup is enough. The message filter passes the path
+  // once its transform to the global frame at the stamp is available.
+  geometry_msgs::TransformStamped transform;
   try
   {
-    for (auto &pose : edge_points_on_path_.value().poses)
-      listener_.transformPose(robot_frame_, ros::Time(0), pose, msg->header.frame_id, pose);
+    transform = tf_buffer_.lookupTransform(global_frame_, msg->header.frame_id, msg->header.stamp);
   }
-  catch (tf::TransformException ex)
+  catch (const tf2::TransformException &ex)
   {
     ROS_ERROR("%s", ex.what());
+    return;
   }
+  Eigen::Matrix2Xd points(2, msg->poses.size());
+  for (int i = 0; i < msg->poses.size(); i++)
+    points.col(i) << msg->poses[i].pose.position.x, msg->poses[i].pose.position.y;
+  // the path is planar, so the transform is applied as a 2-D rigid transform to all points at once
+  const Eigen::Rotation2Dd rotation(tf2::getYaw(transform.transform.rotation));
+  const Eigen::Vector2d translation(transform.transform.translation.x, transform.transform.translation.y);
+  points = (rotation.toRotationMatrix() * points).colwise() + translation;
+  // the distance grid around the robot is built by the next cycle, so the path cost of a state is a lookup
+  path_distance_.set_path(points);
+  edge_points_on_path_ = std::move(points);
 }
 
-std::vector<DWAPlanner::State>
-DWAPlanner::dwa_planning(const Eigen::Vector3d &goal, std::vector<std::pair<std::vector<State>, bool>> &trajectories)
+int DWAPlanner::dwa_planning(const Eigen::Vector3d &goal)
 {
   Cost min_cost(0.0, 0.0, 0.0, 0.0, 1e6);
   const Window dynamic_window = calc_dynamic_window();
-  std::vector<State> best_traj;
-  best_traj.resize(sim_time_samples_);
-  std::vector<Cost> costs;
-  const size_t costs_size = velocity_samples_ * (yawrate_samples_ + 1);
-  costs.reserve(costs_size);
-
-  const double velocity_resolution =
-      std::max((dynamic_window.max_velocity_ - dynamic_window.min_velocity_) / (velocity_samples_ - 1), DBL_EPSILON);
-  const double yawrate_resolution =
-      std::max((dynamic_window.max_yawrate_ - dynamic_window.min_yawrate_) / (yawrate_samples_ - 1), DBL_EPSILON);
-
+  trajectories_.reset(sim_time_samples_, critics_.size());
+  arc_table_.reset(predict_time_, sim_time_samples_);
+  prepare_critics(goal, dynamic_window);
+
+  const SamplingGrid velocity_grid(dynamic_window.min_velocity_, dynamic_window.max_velocity_, velocity_samples_);
+  const SamplingGrid yawrate_grid(dynamic_window.min_yawrate_, dynamic_window.max_yawrate_, yawrate_samples_);
+  const SamplingGrid lateral_velocity_grid(
+      dynamic_window.min_lateral_velocity_, dynamic_window.max_lateral_velocity_,
+      use_holonomic_ ? lateral_velocity_samples_ : 1);
+
+  // candidates snapped to the same primitive are evaluated only once
+  candidate_keys_.clear();
+  candidate_lateral_keys_.clear();
+  candidate_key_set_.clear();
   int available_traj_count = 0;
-  for (int i = 0; i < velocity_samples_; i++)
+  for (int i = 0; i < velocity_grid.size(); i++)
   {
-    const double v = dynamic_window.min_velocity_ + velocity_resolution * i;
-    for (int j = 0; j < yawrate_samples_; j++)
+    const double v = velocity_grid.sample(i);
+    for (int k = 0; k < lateral_velocity_grid.size(); k++)
+      add_yawrate_candidates(v, lateral_velocity_grid.sample(k), dynamic_window, yawrate_grid);
+    if (dynamic_window.min_lateral_velocity_ < 0.0 && 0.0 < dynamic_window.max_lateral_velocity_)
+      add_yawrate_candidates(v, 0.0, dynamic_window, yawrate_grid);
+  }
+  deadline_hit_ = false;
+  if (0.0 < planning_deadline_ratio_)
+  {
+    add_candidate(
+        dynamic_window.min_velocity_, calc_stop_yawrate(dynamic_window), calc_stop_lateral_velocity(dynamic_window));
+  }
+  evaluate_candidates(dynamic_window);
+
+  // the branch and bound does not know the costs of most candidates, so it never refines
+  if (!use_branch_and_bound_)
+  {
+    for (int level = 1; level <= adaptive_sampling_levels_ && !is_past_deadline(); level++)
     {
-      std::pair<std::vector<State>, bool> traj;
-      double y = dynamic_window.min_yawrate_ + yawrate_resolution * j;
-      if (v < slow_velocity_th_)
-        y = y > 0 ? std::max(y, min_yawrate_) : std::min(y, -min_yawrate_);
-      traj.first = generate_trajectory(v, y);
-      const Cost cost = evaluate_trajectory(traj.first, goal);
-      costs.push_back(cost);
-      if (cost.obs_cost_ == 1e6)
-      {
-        traj.second = false;
-      }
-      else
-      {
-        traj.second = true;
-        available_traj_count++;
-      }
-      trajectories.push_back(traj);
+      const int refined_count = refine_candidates(
+          dynamic_window, velocity_grid.resolution() / (1 << level), yawrate_grid.resolution() / (1 << level),
+          lateral_velocity_grid.resolution() / (1 << level));
+      if (refined_count == 0)
+        break;
+      evaluate_candidates(dynamic_window);
     }
+  }
+
+  const int candidate_count = trajectories_.size();
+  int best_index =
+      use_branch_and_bound_ ? select_trajectory_by_branch_and_bound(min_cost) : select_trajectory(min_cost);
+  for (int i = 0; i < candidate_count; i++)
+  {
+    if (trajectories_.valid_[i])
+      available_traj_count++;
+  }
+  if (deadline_hit_ || is_past_deadline())
+  {
+    deadline_hit_count_++;
+    ROS_WARN_THROTTLE(1.0, "Planning deadline was hit, not all candidates were evaluated");
+  }
+  if (best_index < 0)
+  {
+    ROS_ERROR_THROTTLE(1.0, "No available trajectory");
+    generate_trajectory(0.0, 0.0, primitive_);
+    best_index = add_trajectory(primitive_);
+  }
+
+  ROS_INFO("===");
+  ROS_INFO_STREAM(
+      "(v, y) = (" << trajectories_.velocity_[best_index] << ", " << trajectories_.yawrate_[best_index] << ")");
+  min_cost.show();
+  ROS_INFO_STREAM("num of trajectories available: " << available_traj_count << " of " << candidate_count);
+  ROS_INFO(" ");
+
+  last_velocity_ = trajectories_.velocity_[best_index];
+  last_yawrate_ = trajectories_.yawrate_[best_index];
+  last_lateral_velocity_ = trajectories_.lateral_velocity_[best_index];
+  return best_index;
+}
+
+bool DWAPlanner::add_candidate(const double velocity, const double yawrate, const double lateral_velocity)
+{
+  const uint64_t key = calc_primitive_key(velocity, yawrate);
+  const int32_t lateral_key = std::lround(lateral_velocity / primitive_resolution_);
+  if (!candidate_key_set_.emplace(key, lateral_key).second)
+    return false;
+  candidate_keys_.push_back(key);
+  candidate_lateral_keys_.push_back(lateral_key);
+  return true;
+}
+
+void DWAPlanner::add_yawrate_candidates(
+    const double velocity, const double lateral_velocity, const Window &dynamic_window,
+    const SamplingGrid &yawrate_grid)
+{
+  // a holonomic robot moving sideways is not slow even if its forward velocity is
+  const double speed = use_holonomic_ ? hypot(velocity, lateral_velocity) : velocity;
+  for (int j = 0; j < yawrate_grid.size(); j++)
+  {
+    double y = yawrate_grid.sample(j);
+    if (speed < slow_velocity_th_)
+      y = y > 0 ? std::max(y, min_yawrate_) : std::min(y, -min_yawrate_);
+    add_candidate(velocity, y, lateral_velocity);
+  }
+  if (dynamic_window.min_yawrate_ < 0.0 && 0.0 < dynamic_window.max_yawrate_)
+    add_candidate(velocity, 0.0, lateral_velocity);
+}
+
+void DWAPlanner::evaluate_candidates(const Window &dynamic_window)
+{
+  const int begin = trajectories_.size();
+  for (int i = begin; i < candidate_keys_.size(); i++)
+  {
+    double velocity, yawrate;
+    calc_primitive_velocity(candidate_keys_[i], velocity, yawrate);
+    trajectories_.add(velocity, yawrate, candidate_lateral_keys_[i] * primitive_resolution_);
+  }
+  evaluation_order_.clear();
+  for (int i = begin; i < trajectories_.size(); i++)
+    evaluation_order_.push_back(i);
+  if (0.0 < planning_deadline_ratio_)
+  {
+    // the candidates left when the deadline is hit should be the least promising ones
+    candidate_priorities_.resize(trajectories_.size());
+    for (int i = begin; i < trajectories_.size(); i++)
+      candidate_priorities_[i] = calc_priority(i, dynamic_window);
+    std::sort(
+        evaluation_order_.begin(), evaluation_order_.end(), [&](const int a, const int b)
+        { return std::make_pair(candidate_priorities_[a], a) < std::make_pair(candidate_priorities_[b], b); });
+  }
 
-    if (dynamic_window.min_yawrate_ < 0.0 && 0.0 < dynamic_window.max_yawrate_)
+  // the primitives in the library are read by the tasks, the others are cached or generated
+  library_indices_.resize(trajectories_.size());
+  arc_indices_.resize(trajectories_.size());
+  for (int i = begin; i < trajectories_.size(); i++)
+  {
+    const uint64_t key = candidate_keys_[i];
+    library_indices_[i] = use_holonomic_ ? -1
+                                         : primitive_library_.find(
+                                               static_cast<int32_t>(key >> 32), static_cast<int32_t>(key & 0xffffffff));
+    // the table is not thread safe either, but a cycle adds only a few tens of arcs
+    if (use_holonomic_)
+      arc_indices_[i] = arc_table_.add(trajectories_.yawrate_[i]);
+  }
+
+  // the neighbors of the last command and the stopping candidate are evaluated even after the deadline, so a cycle
+  // always has a command within the dynamic window to fall back on, and they lead the order of priority
+  candidate_required_.resize(trajectories_.size());
+  candidate_evaluated_.resize(trajectories_.size());
+  for (int i = begin; i < trajectories_.size(); i++)
+  {
+    candidate_required_[i] =
+        begin == 0 && 0.0 < planning_deadline_ratio_ && candidate_priorities_[i] <= calc_required_priority();
+    candidate_evaluated_[i] = false;
+  }
+  int required_count = 0;
+  while (required_count < evaluation_order_.size() && candidate_required_[evaluation_order_[required_count]])
+    required_count++;
+
+  // the cache is not thread safe, so the cached primitives of a chunk are copied before its parallel evaluation
+  const bool use_cache = 0 < primitive_cache_size_ && !use_holonomic_;
+  const int task_count = evaluation_order_.size();
+  const int batch_size = 16;
+  const int chunk_size = use_cache ? batch_size * evaluation_pool_.size() : task_count;
+  for (int chunk_begin = 0; chunk_begin < task_count; chunk_begin += chunk_size)
+  {
+    if (required_count <= chunk_begin && is_past_deadline())
     {
-      std::pair<std::vector<State>, bool> traj;
-      traj.first = generate_trajectory(v, 0.0);
-      const Cost cost = evaluate_trajectory(traj.first, goal);
-      costs.push_back(cost);
-      if (cost.obs_cost_ == 1e6)
-      {
-        traj.second = false;
-      }
-      else
+      deadline_hit_ = true;
+      break;
+    }
+    const int chunk_end = std::min(chunk_begin + chunk_size, task_count);
+    if (use_cache)
+    {
+      for (int task = chunk_begin; task < chunk_end; task++)
       {
-        traj.second = true;
-        available_traj_count++;
+        const int index = evaluation_order_[task];
+        if (library_indices_[index] < 0)
+          set_trajectory(index, get_primitive(candidate_keys_[index]));
       }
-      trajectories.push_back(traj);
     }
+    // every candidate is written only by the task of its batch, so the result does not depend on the number of
+    // threads
+    evaluation_pool_.run(
+        (chunk_end - chunk_begin + batch_size - 1) / batch_size,
+        [&](const int batch, const int thread)
+        {
+          const int begin = chunk_begin + batch * batch_size;
+          const int end = std::min(begin + batch_size, chunk_end);
+          int count = 0;
+          for (int task = begin; task < end; task++, count++)
+          {
+            // a skipped candidate stays invalid
+            if (required_count <= task && is_past_deadline())
+            {
+              deadline_hit_ = true;
+              break;
+            }
+            const int index = evaluation_order_[task];
+            const int library_index = library_indices_[index];
+            if (use_holonomic_)
+            {
+              arc_table_.rollout(
+                  arc_indices_[index], trajectories_.velocity_[index], trajectories_.lateral_velocity_[index],
+                  trajectories_.x(index), trajectories_.y(index), trajectories_.yaw(index));
+            }
+            else if (0 <= library_index)
+            {
+              set_trajectory(
+                  index, primitive_library_.x(library_index), primitive_library_.y(library_index),
+                  primitive_library_.yaw(library_index));
+            }
+            else if (!use_cache)
+            {
+              std::vector<State> &trajectory = thread_trajectories_[thread];
+              rollout(trajectories_.velocity_[index], trajectories_.yawrate_[index], trajectory);
+              set_trajectory(index, trajectory);
+            }
+          }
+          evaluate_trajectories(evaluation_order_.data() + begin, count);
+        });
   }
+}
+
+double DWAPlanner::calc_stop_yawrate(const Window &dynamic_window)
+{
+  return std::min(std::max(0.0, dynamic_window.min_yawrate_), dynamic_window.max_yawrate_);
+}
+
+double DWAPlanner::calc_stop_lateral_velocity(const Window &dynamic_window)
+{
+  return std::min(std::max(0.0, dynamic_window.min_lateral_velocity_), dynamic_window.max_lateral_velocity_);
+}
+
+float DWAPlanner::calc_required_priority(void) { return use_holonomic_ ? sqrt(3.0) : M_SQRT2; }
+
+float DWAPlanner::calc_priority(const int index, const Window &dynamic_window)
+{
+  // the distance from the last selected command in grid cells
+  const double velocity_cells = (trajectories_.velocity_[index] - last_velocity_) *
+                                std::max(velocity_samples_ - 1, 1) /
+                                std::max(dynamic_window.max_velocity_ - dynamic_window.min_velocity_, DBL_EPSILON);
+  const double yawrate_cells = (trajectories_.yawrate_[index] - last_yawrate_) * std::max(yawrate_samples_ - 1, 1) /
+                               std::max(dynamic_window.max_yawrate_ - dynamic_window.min_yawrate_, DBL_EPSILON);
+  const double lateral_velocity_cells =
+      use_holonomic_ ? (trajectories_.lateral_velocity_[index] - last_lateral_velocity_) *
+                           std::max(lateral_velocity_samples_ - 1, 1) /
+                           std::max(
+                               dynamic_window.max_lateral_velocity_ - dynamic_window.min_lateral_velocity_,
+                               DBL_EPSILON)
+                     : 0.0;
+  const float cells = hypot(hypot(velocity_cells, yawrate_cells), lateral_velocity_cells);
+  // the neighbors of the last command, then stopping, then the others from near to far
+  const float neighbor_cells = calc_required_priority();
+  if (cells <= neighbor_cells)
+    return cells;
+  if (calc_primitive_key(trajectories_.velocity_[index], trajectories_.yawrate_[index]) ==
+          calc_primitive_key(dynamic_window.min_velocity_, calc_stop_yawrate(dynamic_window)) &&
+      std::lround(trajectories_.lateral_velocity_[index] / primitive_resolution_) ==
+          std::lround(calc_stop_lateral_velocity(dynamic_window) / primitive_resolution_))
+    return neighbor_cells;
+  return neighbor_cells + cells;
+}
+
+bool DWAPlanner::is_past_deadline(void)
+{
+  return 0.0 < planning_deadline_ratio_ && deadline_ < ros::WallTime::now();
+}
 
-  if (available_traj_count == 0)
+int DWAPlanner::refine_candidates(
+    const Window &dynamic_window, const double velocity_resolution, const double yawrate_resolution,
+    const double lateral_velocity_resolution)
+{
+  // rank the valid candidates by the total cost normalized over the candidates evaluated so far
+  calc_normalized_total_costs(candidate_costs_);
+  candidate_order_.clear();
+  for (int i = 0; i < trajectories_.size(); i++)
   {
-    ROS_ERROR_THROTTLE(1.0, "No available trajectory");
-    best_traj = generate_trajectory(0.0, 0.0);
+    if (trajectories_.valid_[i])
+      candidate_order_.push_back(i);
   }
-  else
+  const int cell_count = std::min(adaptive_sampling_cells_, static_cast<int>(candidate_order_.size()));
+  std::partial_sort(
+      candidate_order_.begin(), candidate_order_.begin() + cell_count, candidate_order_.end(),
+      [&](const int a, const int b)
+      { return std::make_pair(candidate_costs_[a], a) < std::make_pair(candidate_costs_[b], b); });
+
+  // sample the neighbors of the best candidates at the finer resolution
+  const int candidate_count = candidate_keys_.size();
+  const int lateral_velocity_steps = use_holonomic_ ? 1 : 0;
+  for (int i = 0; i < cell_count; i++)
   {
-    normalize_costs(costs);
-    for (int i = 0; i < costs.size(); i++)
+    const int index = candidate_order_[i];
+    for (int dl = -lateral_velocity_steps; dl <= lateral_velocity_steps; dl++)
     {
-      if (costs[i].obs_cost_ != 1e6)
+      const double l = trajectories_.lateral_velocity_[index] + lateral_velocity_resolution * dl;
+      if (l < dynamic_window.min_lateral_velocity_ || dynamic_window.max_lateral_velocity_ < l)
+        continue;
+      for (int dv = -1; dv <= 1; dv++)
       {
-        costs[i].to_goal_cost_ *= to_goal_cost_gain_;
-        costs[i].obs_cost_ *= obs_cost_gain_;
-        costs[i].speed_cost_ *= speed_cost_gain_;
-        costs[i].path_cost_ *= path_cost_gain_;
-        costs[i].calc_total_cost();
-        if (costs[i].total_cost_ < min_cost.total_cost_)
+        for (int dy = -1; dy <= 1; dy++)
         {
-          min_cost = costs[i];
-          best_traj = trajectories[i].first;
+          if (adaptive_sampling_budget_ <= candidate_keys_.size())
+            return candidate_keys_.size() - candidate_count;
+          const double v = trajectories_.velocity_[index] + velocity_resolution * dv;
+          double y = trajectories_.yawrate_[index] + yawrate_resolution * dy;
+          if (v < dynamic_window.min_velocity_ || dynamic_window.max_velocity_ < v ||
+              y < dynamic_window.min_yawrate_ || dynamic_window.max_yawrate_ < y)
+            continue;
+          const double speed = use_holonomic_ ? hypot(v, l) : v;
+          if (speed < slow_velocity_th_ && y != 0.0)
+            y = y > 0 ? std::max(y, min_yawrate_) : std::min(y, -min_yawrate_);
+          add_candidate(v, y, l);
         }
       }
     }
   }
+  return candidate_keys_.size() - candidate_count;
+}
 
-  ROS_INFO("===");
-  ROS_INFO_STREAM("(v, y) = (" << best_traj.front().velocity_ << ", " << best_traj.front().yawrate_ << ")");
-  min_cost.show();
-  ROS_INFO_STREAM("num of trajectories available: " << available_traj_count << " of " << trajectories.size());
-  ROS_INFO(" ");
+void DWAPlanner::calc_normalized_total_costs(std::vector<float> &total_costs)
+{
+  float min_obs = 1e6, max_obs = 0.0, min_to_goal = 1e6, max_to_goal = 0.0;
+  float min_speed = 1e6, max_speed = 0.0, min_path = 1e6, max_path = 0.0;
+  for (int i = 0; i < trajectories_.size(); i++)
+  {
+    if (!trajectories_.valid_[i])
+      continue;
+    min_obs = std::min(min_obs, trajectories_.obs_cost_[i]);
+    max_obs = std::max(max_obs, trajectories_.obs_cost_[i]);
+    min_to_goal = std::min(min_to_goal, trajectories_.to_goal_cost_[i]);
+    max_to_goal = std::max(max_to_goal, trajectories_.to_goal_cost_[i]);
+    min_speed = std::min(min_speed, trajectories_.speed_cost_[i]);
+    max_speed = std::max(max_speed, trajectories_.speed_cost_[i]);
+    min_path = std::min(min_path, trajectories_.path_cost_[i]);
+    max_path = std::max(max_path, trajectories_.path_cost_[i]);
+  }
 
-  return best_traj;
+  total_costs.resize(trajectories_.size());
+  for (int i = 0; i < trajectories_.size(); i++)
+  {
+    Cost cost(
+        obs_cost_gain_ * (trajectories_.obs_cost_[i] - min_obs) / (max_obs - min_obs + DBL_EPSILON),
+        to_goal_cost_gain_ * (trajectories_.to_goal_cost_[i] - min_to_goal) / (max_to_goal - min_to_goal + DBL_EPSILON),
+        speed_cost_gain_ * (trajectories_.speed_cost_[i] - min_speed) / (max_speed - min_speed + DBL_EPSILON),
+        path_cost_gain_ * (trajectories_.path_cost_[i] - min_path) / (max_path - min_path + DBL_EPSILON), 0.0);
+    cost.calc_total_cost();
+    total_costs[i] = cost.total_cost_;
+  }
+
+  for (int k = 0; k < critics_.size(); k++)
+  {
+    const std::vector<float> &costs = trajectories_.critic_costs_[k];
+    float min_cost = 1e6, max_cost = 0.0;
+    for (int i = 0; i < trajectories_.size(); i++)
+    {
+      if (!trajectories_.valid_[i])
+        continue;
+      min_cost = std::min(min_cost, costs[i]);
+      max_cost = std::max(max_cost, costs[i]);
+    }
+    for (int i = 0; i < trajectories_.size(); i++)
+      total_costs[i] += critic_gains_[k] * (costs[i] - min_cost) / (max_cost - min_cost + DBL_EPSILON);
+  }
 }
 
-void DWAPlanner::normalize_costs(std::vector<DWAPlanner::Cost> &costs)
+int DWAPlanner::select_trajectory(Cost &min_cost)
 {
-  Cost min_cost(1e6, 1e6, 1e6, 1e6, 1e6), max_cost;
+  normalize_costs(trajectories_.obs_cost_, trajectories_.valid_);
+  normalize_costs(trajectories_.to_goal_cost_, trajectories_.valid_);
+  if (use_speed_cost_)
+    normalize_costs(trajectories_.speed_cost_, trajectories_.valid_);
+  if (use_path_cost_)
+    normalize_costs(trajectories_.path_cost_, trajectories_.valid_);
+  for (auto &costs : trajectories_.critic_costs_)
+    normalize_costs(costs, trajectories_.valid_);
+
+  int best_index = -1;
+  for (int i = 0; i < trajectories_.size(); i++)
+  {
+    if (!trajectories_.valid_[i])
+      continue;
+    Cost cost(
+        trajectories_.obs_cost_[i] * obs_cost_gain_, trajectories_.to_goal_cost_[i] * to_goal_cost_gain_,
+        trajectories_.speed_cost_[i] * speed_cost_gain_, trajectories_.path_cost_[i] * path_cost_gain_, 0.0);
+    cost.critic_cost_ = calc_critic_cost(i);
+    cost.calc_total_cost();
+    trajectories_.total_cost_[i] = cost.total_cost_;
+    if (cost.total_cost_ < min_cost.total_cost_)
+    {
+      min_cost = cost;
+      best_index = i;
+    }
+  }
+  return best_index;
+}
 
-  for (const auto &cost : costs)
+int DWAPlanner::select_trajectory_by_branch_and_bound(Cost &min_cost)
+{
+  // fixed bounds make the cost of a candidate independent of the other candidates
+  const double max_speed = use_holonomic_ ? hypot(max_velocity_, max_lateral_velocity_) : max_velocity_;
+  candidate_order_.clear();
+  for (int i = 0; i < trajectories_.size(); i++)
   {
-    if (cost.obs_cost_ != 1e6)
+    // the candidates skipped at the deadline and the rejected ones stay invalid
+    if (!candidate_evaluated_[i] || is_rejected_by_critics(i))
+      continue;
+    trajectories_.to_goal_cost_[i] /= to_goal_cost_bound_ + DBL_EPSILON;
+    trajectories_.speed_cost_[i] /= max_speed + DBL_EPSILON;
+    trajectories_.path_cost_[i] /= path_cost_bound_ + DBL_EPSILON;
+    for (int k = 0; k < critics_.size(); k++)
+      trajectories_.critic_costs_[k][i] /= critic_bounds_[k] + DBL_EPSILON;
+    Cost bound(
+        0.0, trajectories_.to_goal_cost_[i] * to_goal_cost_gain_, trajectories_.speed_cost_[i] * speed_cost_gain_,
+        trajectories_.path_cost_[i] * path_cost_gain_, 0.0);
+    bound.critic_cost_ = calc_critic_cost(i);
+    bound.calc_total_cost();
+    trajectories_.total_cost_[i] = bound.total_cost_;
+    candidate_order_.push_back(i);
+  }
+  // the most promising candidates first, so that the best one is found early and bounds the others
+  std::sort(
+      candidate_order_.begin(), candidate_order_.end(), [&](const int a, const int b)
+      { return std::make_pair(trajectories_.total_cost_[a], a) < std::make_pair(trajectories_.total_cost_[b], b); });
+
+  int best_index = -1;
+  for (const int i : candidate_order_)
+  {
+    // only the required candidates are still checked after the deadline, so the best known one is selected
+    if (!candidate_required_[i] && is_past_deadline())
     {
-      min_cost.obs_cost_ = std::min(min_cost.obs_cost_, cost.obs_cost_);
-      max_cost.obs_cost_ = std::max(max_cost.obs_cost_, cost.obs_cost_);
-      min_cost.to_goal_cost_ = std::min(min_cost.to_goal_cost_, cost.to_goal_cost_);
-      max_cost.to_goal_cost_ = std::max(max_cost.to_goal_cost_, cost.to_goal_cost_);
-      if (use_speed_cost_)
-      {
-        min_cost.speed_cost_ = std::min(min_cost.speed_cost_, cost.speed_cost_);
-        max_cost.speed_cost_ = std::max(max_cost.speed_cost_, cost.speed_cost_);
-      }
-      if (use_path_cost_)
-      {
-        min_cost.path_cost_ = std::min(min_cost.path_cost_, cost.path_cost_);
-        max_cost.path_cost_ = std::max(max_cost.path_cost_, cost.path_cost_);
-      }
+      deadline_hit_ = true;
+      continue;
+    }
+    // the obstacle cost is not negative, so the total cost without it is a lower bound and the rest cannot win
+    if (std::make_pair(min_cost.total_cost_, best_index) < std::make_pair(trajectories_.total_cost_[i], i))
+      break;
+    const float obs_cost = obstacle_critic_.calc_cost(trajectories_, i);
+    if (obs_cost == dwa_planner::CostCritic::INFEASIBLE_COST)
+      continue;
+    trajectories_.valid_[i] = true;
+    trajectories_.obs_cost_[i] = obs_cost / (obs_range_ + DBL_EPSILON);
+    Cost cost(
+        trajectories_.obs_cost_[i] * obs_cost_gain_, trajectories_.to_goal_cost_[i] * to_goal_cost_gain_,
+        trajectories_.speed_cost_[i] * speed_cost_gain_, trajectories_.path_cost_[i] * path_cost_gain_, 0.0);
+    cost.critic_cost_ = calc_critic_cost(i);
+    cost.calc_total_cost();
+    trajectories_.total_cost_[i] = cost.total_cost_;
+    if (std::make_pair(cost.total_cost_, i) < std::make_pair(min_cost.total_cost_, best_index))
+    {
+      min_cost = cost;
+      best_index = i;
     }
   }
+  return best_index;
+}
 
-  for (auto &cost : costs)
+void DWAPlanner::normalize_costs(std::vector<float> &costs, const std::vector<uint8_t> &valid)
+{
+  float min_cost = 1e6, max_cost = 0.0;
+  for (int i = 0; i < costs.size(); i++)
   {
-    if (cost.obs_cost_ != 1e6)
+    if (valid[i])
     {
-      cost.obs_cost_ = (cost.obs_cost_ - min_cost.obs_cost_) / (max_cost.obs_cost_ - min_cost.obs_cost_ + DBL_EPSILON);
-      cost.to_goal_cost_ = (cost.to_goal_cost_ - min_cost.to_goal_cost_) /
-                           (max_cost.to_goal_cost_ - min_cost.to_goal_cost_ + DBL_EPSILON);
-      if (use_speed_cost_)
-        cost.speed_cost_ =
-            (cost.speed_cost_ - min_cost.speed_cost_) / (max_cost.speed_cost_ - min_cost.speed_cost_ + DBL_EPSILON);
-      if (use_path_cost_)
-        cost.path_cost_ =
-            (cost.path_cost_ - min_cost.path_cost_) / (max_cost.path_cost_ - min_cost.path_cost_ + DBL_EPSILON);
+      min_cost = std::min(min_cost, costs[i]);
+      max_cost = std::max(max_cost, costs[i]);
     }
   }
+
+  for (int i = 0; i < costs.size(); i++)
+  {
+    if (valid[i])
+      costs[i] = (costs[i] - min_cost) / (max_cost - min_cost + DBL_EPSILON);
+  }
 }
 
 void DWAPlanner::process(void)
 {
+  if (use_sensor_thread_)
+    sensor_spinner_.start();
   ros::Rate loop_rate(hz_);
   while (ros::ok())
   {
+    const ros::WallTime cycle_start = ros::WallTime::now();
     geometry_msgs::Twist cmd_vel;
+    // the whole cycle reads one snapshot, released afterwards so that its buffer can be reused
+    obstacles_ = std::atomic_load(&obstacle_snapshot_);
     if (can_move())
       cmd_vel = calc_cmd_vel();
+    obstacles_.reset();
 
     traj_planner::Weights weights_msg;
     weights_msg.header.stamp = ros::Time::now();
@@ -358,21 +756,76 @@ void DWAPlanner::process(void)
 
     velocity_pub_.publish(cmd_vel);
     finish_flag_pub_.publish(has_finished_);
+    std_msgs::Int32 deadline_hits;
+    deadline_hits.data = deadline_hit_count_;
+    deadline_hits_pub_.publish(deadline_hits);
     if (has_finished_.data)
       ros::Duration(sleep_time_after_finish_).sleep();
 
-    if (use_scan_as_input_)
-      scan_updated_ = false;
-    else
-      local_map_updated_ = false;
-    odom_updated_ = false;
     has_finished_.data = false;
 
+    if (use_sensor_trigger_)
+    {
+      wait_for_trigger(cycle_start);
+      continue;
+    }
     ros::spinOnce();
     loop_rate.sleep();
   }
 }
 
+void DWAPlanner::wait_for_trigger(const ros::WallTime &cycle_start)
+{
+  const ros::WallTime earliest = cycle_start + ros::WallDuration(1.0 / max_hz_);
+  const ros::WallTime latest = cycle_start + ros::WallDuration(1.0 / hz_);
+  if (use_sensor_thread_)
+  {
+    // the other callbacks keep only their latest messages, so serving them once before planning is enough
+    const ros::WallTime now = ros::WallTime::now();
+    if (now < earliest)
+      (earliest - now).sleep();
+    std::unique_lock<std::mutex> lock(trigger_mutex_);
+    trigger_cv_.wait_for(
+        lock, std::chrono::duration<double>((latest - ros::WallTime::now()).toSec()),
+        [this] { return has_new_obstacles_; });
+    has_new_obstacles_ = false;
+    lock.unlock();
+    ros::spinOnce();
+    return;
+  }
+  // the sensor callbacks run here, so any callback wakes this thread to check for new obstacles
+  ros::CallbackQueue &queue = *ros::getGlobalCallbackQueue();
+  for (ros::WallTime now = ros::WallTime::now(); now < earliest; now = ros::WallTime::now())
+    queue.callAvailable(earliest - now);
+  for (ros::WallTime now = ros::WallTime::now(); now < latest && !take_trigger(); now = ros::WallTime::now())
+    queue.callAvailable(latest - now);
+}
+
+bool DWAPlanner::take_trigger(void)
+{
+  std::lock_guard<std::mutex> lock(trigger_mutex_);
+  const bool has_new_obstacles = has_new_obstacles_;
+  has_new_obstacles_ = false;
+  return has_new_obstacles;
+}
+
+bool DWAPlanner::update_transform_snapshot(void)
+{
+  geometry_msgs::TransformStamped transform;
+  try
+  {
+    transform = tf_buffer_.lookupTransform(robot_frame_, global_frame_, ros::Time(0));
+  }
+  catch (const tf2::TransformException &ex)
+  {
+    ROS_ERROR_THROTTLE(1.0, "%s", ex.what());
+    return false;
+  }
+  global_to_robot_ = Eigen::Translation2d(transform.transform.translation.x, transform.transform.translation.y) *
+                     Eigen::Rotation2Dd(tf2::getYaw(transform.transform.rotation));
+  return true;
+}
+
 bool DWAPlanner::can_move(void)
 {
   if (!footprint_.has_value())
@@ -381,23 +834,26 @@ bool DWAPlanner::can_move(void)
     ROS_WARN_THROTTLE(1.0, "Local goal has not been updated");
   if (!edge_points_on_path_.has_value())
     ROS_WARN_THROTTLE(1.0, "Edge on global path has not been updated");
-  if (subscribe_count_th_ < odom_not_subscribe_count_)
+  // the staleness is measured in time rather than in cycles, as the cycles follow the sensor with USE_SENSOR_TRIGGER
+  const double now = ros::Time::now().toSec();
+  const double stale_time = subscribe_count_th_ / hz_;
+  const bool use_local_map = !use_scan_as_input_ && !use_cloud_as_input_;
+  const bool use_scan = use_scan_as_input_ && !use_cloud_as_input_;
+  const bool is_odom_stale = stale_time < now - odom_received_time_;
+  const bool is_local_map_stale = use_local_map && stale_time < now - local_map_received_time_;
+  const bool is_scan_stale = use_scan && stale_time < now - scan_received_time_;
+  const bool is_cloud_stale = use_cloud_as_input_ && stale_time < now - cloud_received_time_;
+  if (is_odom_stale)
     ROS_WARN_THROTTLE(1.0, "Odom has not been updated");
-  if (subscribe_count_th_ < local_map_not_subscribe_count_)
+  if (is_local_map_stale)
     ROS_WARN_THROTTLE(1.0, "Local map has not been updated");
-  if (subscribe_count_th_ < scan_not_subscribe_count_)
+  if (is_scan_stale)
     ROS_WARN_THROTTLE(1.0, "Scan has not been updated");
+  if (is_cloud_stale)
+    ROS_WARN_THROTTLE(1.0, "Cloud has not been updated");
 
-  if (!odom_updated_)
-    odom_not_subscribe_count_++;
-  if (!local_map_updated_)
-    local_map_not_subscribe_count_++;
-  if (!scan_updated_)
-    scan_not_subscribe_count_++;
-
-  if (footprint_.has_value() && goal_msg_.has_value() && edge_points_on_path_.has_value() &&
-      odom_not_subscribe_count_ <= subscribe_count_th_ && local_map_not_subscribe_count_ <= subscribe_count_th_ &&
-      scan_not_subscribe_count_ <= subscribe_count_th_)
+  if (footprint_.has_value() && goal_msg_.has_value() && edge_points_on_path_.has_value() && !is_odom_stale &&
+      !is_local_map_stale && !is_scan_stale && !is_cloud_stale)
     return true;
   else
     return false;
@@ -406,21 +862,18 @@ bool DWAPlanner::can_move(void)
 geometry_msgs::Twist DWAPlanner::calc_cmd_vel(void)
 {
   geometry_msgs::Twist cmd_vel;
-  std::pair<std::vector<State>, bool> best_traj;
-  std::vector<std::pair<std::vector<State>, bool>> trajectories;
-  const size_t trajectories_size = velocity_samples_ * (yawrate_samples_ + 1);
-  trajectories.reserve(trajectories_size);
-
-  geometry_msgs::PoseStamped goal_;
-  try
-  {
-    listener_.transformPose(robot_frame_, ros::Time(0), goal_msg_.value(), goal_msg_.value().header.frame_id, goal_);
-  }
-  catch (tf::TransformException ex)
-  {
-    ROS_ERROR("%s", ex.what());
-  }
-  const Eigen::Vector3d goal(goal_.pose.position.x, goal_.pose.position.y, tf::getYaw(goal_.pose.orientation));
+  int best_index;
+  trajectories_.reset(sim_time_samples_, critics_.size());
+  deadline_ = ros::WallTime::now() + ros::WallDuration(planning_deadline_ratio_ / hz_);
+
+  // the goal is kept in the global frame and moved to the robot frame with the transform of this cycle
+  if (!update_transform_snapshot())
+    return cmd_vel;
+  const geometry_msgs::Pose &goal_pose = goal_msg_.value().pose;
+  const Eigen::Vector2d goal_position = global_to_robot_ * Eigen::Vector2d(goal_pose.position.x, goal_pose.position.y);
+  const Eigen::Rotation2Dd goal_rotation(
+      tf2::getYaw(goal_pose.orientation) + Eigen::Rotation2Dd(global_to_robot_.linear()).angle());
+  const Eigen::Vector3d goal(goal_position.x(), goal_position.y(), goal_rotation.smallestAngle());
 
   const double angle_to_goal = atan2(goal.y(), goal.x());
   if (M_PI / 4.0 < fabs(angle_to_goal))
@@ -434,14 +887,15 @@ geometry_msgs::Twist DWAPlanner::calc_cmd_vel(void)
                                             : std::max(angle_to_goal, -max_in_place_yawrate_);
       cmd_vel.angular.z = cmd_vel.angular.z > 0 ? std::max(cmd_vel.angular.z, min_in_place_yawrate_)
                                                 : std::min(cmd_vel.angular.z, -min_in_place_yawrate_);
-      best_traj.first = generate_trajectory(cmd_vel.angular.z, goal);
-      trajectories.push_back(best_traj);
+      generate_trajectory(cmd_vel.angular.z, goal, primitive_);
+      best_index = add_trajectory(primitive_);
     }
     else
     {
-      best_traj.first = dwa_planning(goal, trajectories);
-      cmd_vel.linear.x = best_traj.first.front().velocity_;
-      cmd_vel.angular.z = best_traj.first.front().yawrate_;
+      best_index = dwa_planning(goal);
+      cmd_vel.linear.x = trajectories_.velocity_[best_index];
+      cmd_vel.linear.y = trajectories_.lateral_velocity_[best_index];
+      cmd_vel.angular.z = trajectories_.yawrate_[best_index];
     }
   }
   else
@@ -459,16 +913,13 @@ geometry_msgs::Twist DWAPlanner::calc_cmd_vel(void)
       has_finished_.data = true;
       has_reached_ = false;
     }
-    best_traj.first = generate_trajectory(cmd_vel.linear.x, cmd_vel.angular.z);
-    trajectories.push_back(best_traj);
+    generate_trajectory(cmd_vel.linear.x, cmd_vel.angular.z, primitive_);
+    best_index = add_trajectory(primitive_);
   }
 
-  for (int i = 0; i < trajectories_size; i++)
-    trajectories.push_back(trajectories.front());
-
-  visualize_trajectory(best_traj.first, selected_trajectory_pub_);
-  visualize_trajectories(trajectories, candidate_trajectories_pub_);
-  visualize_footprints(best_traj.first, predict_footprints_pub_);
+  visualize_trajectory(trajectories_, best_index, selected_trajectory_pub_);
+  visualize_trajectories(trajectories_, candidate_trajectories_pub_);
+  visualize_footprints(trajectories_, best_index, predict_footprints_pub_);
 
   use_speed_cost_ = false;
 
@@ -482,9 +933,9 @@ bool DWAPlanner::can_adjust_robot_direction(const Eigen::Vector3d &goal)
     return false;
 
   const double yawrate = std::min(std::max(angle_to_goal, -max_in_place_yawrate_), max_in_place_yawrate_);
-  std::vector<State> traj = generate_trajectory(yawrate, goal);
+  generate_trajectory(yawrate, goal, primitive_);
 
-  if (!check_collision(traj))
+  if (!check_collision(primitive_))
     return true;
   else
     return false;
@@ -495,14 +946,21 @@ bool DWAPlanner::check_collision(const std::vector<State> &traj)
   if (!use_footprint_)
     return false;
 
+  const ObstacleSnapshot &obstacles = *obstacles_;
   for (const auto &state : traj)
   {
-    for (const auto &obs : obs_list_.poses)
+    if (use_distance_field_ && obstacles.configuration_space_.contains(state.x_, state.y_))
     {
-      const geometry_msgs::PolygonStamped footprint = move_footprint(state);
-      if (is_inside_of_robot(obs.position, footprint, state))
+      if (obstacles.configuration_space_.is_colliding(state.x_, state.y_, state.yaw_))
         return true;
+      continue;
     }
+    const Eigen::Isometry2d to_robot = calc_transform_to_robot(state.x_, state.y_, state.yaw_);
+    const bool is_colliding = obstacles.obs_index_.search_radius(
+        state.x_, state.y_, footprint_cache_->radius_,
+        [&](const int i) { return is_inside_of_robot(obstacles.obs_list_.poses[i].position, to_robot); });
+    if (is_colliding)
+      return true;
   }
 
   return false;
@@ -511,6 +969,25 @@ bool DWAPlanner::check_collision(const std::vector<State> &traj)
 DWAPlanner::Window DWAPlanner::calc_dynamic_window(void)
 {
   Window window;
+  if (use_holonomic_)
+  {
+    // each axis is limited separately, decelerating toward 0 and accelerating away from it
+    const double velocity = current_cmd_vel_.linear.x;
+    const double lateral_velocity = current_cmd_vel_.linear.y;
+    window.min_velocity_ =
+        std::max(velocity - (0.0 < velocity ? max_deceleration_ : max_acceleration_) * sim_period_, min_velocity_);
+    window.max_velocity_ =
+        std::min(velocity + (velocity < 0.0 ? max_deceleration_ : max_acceleration_) * sim_period_, target_velocity_);
+    window.min_lateral_velocity_ = std::max(
+        lateral_velocity - (0.0 < lateral_velocity ? max_deceleration_ : max_acceleration_) * sim_period_,
+        -max_lateral_velocity_);
+    window.max_lateral_velocity_ = std::min(
+        lateral_velocity + (lateral_velocity < 0.0 ? max_deceleration_ : max_acceleration_) * sim_period_,
+        max_lateral_velocity_);
+    window.min_yawrate_ = std::max((current_cmd_vel_.angular.z - max_d_yawrate_ * sim_period_), -max_yawrate_);
+    window.max_yawrate_ = std::min((current_cmd_vel_.angular.z + max_d_yawrate_ * sim_period_), max_yawrate_);
+    return window;
+  }
   Eigen::Vector2d velocity(current_cmd_vel_.linear.x, current_cmd_vel_.linear.y);
   double speed = velocity.norm();
   window.min_velocity_ = std::max((speed - max_deceleration_ * sim_period_), min_velocity_);
@@ -520,333 +997,335 @@ DWAPlanner::Window DWAPlanner::calc_dynamic_window(void)
   return window;
 }
 
-float DWAPlanner::calc_to_goal_cost(const std::vector<State> &traj, const Eigen::Vector3d &goal)
+void DWAPlanner::load_critics(void)
 {
-  Eigen::Vector3d last_position(traj.back().x_, traj.back().y_, traj.back().yaw_);
-  return (last_position.segment(0, 2) - goal.segment(0, 2)).norm();
-}
-
-float DWAPlanner::calc_obs_cost(const std::vector<State> &traj)
-{
-  float min_dist = obs_range_;
-  for (const auto &state : traj)
+  for (const auto &name : critic_names_)
   {
-    for (const auto &obs : obs_list_.poses)
+    // each critic reads its parameters from its own namespace
+    const ros::NodeHandle critic_nh(local_nh_, name);
+    std::string class_name;
+    double gain, bound;
+    critic_nh.param<std::string>("CLASS", class_name, name);
+    critic_nh.param<double>("GAIN", gain, 1.0);
+    critic_nh.param<double>("BOUND", bound, 1.0);
+    try
     {
-      float dist;
-      if (use_footprint_)
-        dist = calc_dist_from_robot(obs.position, state);
-      else
-        dist = hypot((state.x_ - obs.position.x), (state.y_ - obs.position.y)) - robot_radius_ - footprint_padding_;
-
-      if (dist < DBL_EPSILON)
-        return 1e6;
-      min_dist = std::min(min_dist, dist);
+      critics_.push_back(critic_loader_.createInstance(class_name));
     }
+    catch (const pluginlib::PluginlibException &ex)
+    {
+      ROS_ERROR_STREAM("Failed to load the critic " << name << ": " << ex.what());
+      continue;
+    }
+    critic_gains_.push_back(gain);
+    critic_bounds_.push_back(bound);
+    critics_.back()->initialize(critic_nh);
+    ROS_INFO_STREAM("Loaded the critic " << name << " (" << class_name << ")");
   }
-  return obs_range_ - min_dist;
 }
 
-float DWAPlanner::calc_speed_cost(const std::vector<State> &traj)
+void DWAPlanner::prepare_critics(const Eigen::Vector3d &goal, const Window &dynamic_window)
 {
-  if (!use_speed_cost_)
-    return 0.0;
-  const Window dynamic_window = calc_dynamic_window();
-  return dynamic_window.max_velocity_ - traj.front().velocity_;
+  dwa_planner::CriticContext context;
+  context.goal_ = goal;
+  context.max_velocity_ = dynamic_window.max_velocity_;
+  if (use_holonomic_)
+  {
+    // the speed of a holonomic robot includes its lateral velocity
+    const double max_lateral_speed =
+        std::max(fabs(dynamic_window.min_lateral_velocity_), fabs(dynamic_window.max_lateral_velocity_));
+    context.max_velocity_ = hypot(dynamic_window.max_velocity_, max_lateral_speed);
+  }
+  context.use_holonomic_ = use_holonomic_;
+  context.robot_to_global_ = global_to_robot_.inverse();
+  if (use_path_cost_)
+    path_distance_.update(context.robot_to_global_.translation(), distance_field_resolution_, calc_obs_half_size());
+  context.path_distance_ = use_path_cost_ ? &path_distance_ : nullptr;
+  context.obstacles_ = &obstacles_->obs_list_;
+  context.obstacle_snapshot_ = obstacles_.get();
+  obstacle_critic_.prepare(context);
+  to_goal_critic_.prepare(context);
+  speed_critic_.prepare(context);
+  path_critic_.prepare(context);
+  for (auto &critic : critics_)
+    critic->prepare(context);
 }
 
-float DWAPlanner::calc_path_cost(const std::vector<State> &traj)
+float DWAPlanner::calc_critic_cost(const int index)
 {
-  if (!use_path_cost_)
-    return 0.0;
-  else
-    return calc_dist_to_path(traj.back());
+  float cost = 0.0;
+  for (int k = 0; k < critics_.size(); k++)
+    cost += critic_gains_[k] * trajectories_.critic_costs_[k][index];
+  return cost;
 }
 
-float DWAPlanner::calc_dist_to_path(const State state)
+bool DWAPlanner::is_rejected_by_critics(const int index)
 {
-  geometry_msgs::Point edge_point1 = edge_points_on_path_.value().poses.front().pose.position;
-  geometry_msgs::Point edge_point2 = edge_points_on_path_.value().poses.back().pose.position;
-  const float a = edge_point2.y - edge_point1.y;
-  const float b = -(edge_point2.x - edge_point1.x);
-  const float c = -a * edge_point1.x - b * edge_point1.y;
-
-  return fabs(a * state.x_ + b * state.y_ + c) / (hypot(a, b) + DBL_EPSILON);
+  for (const auto &costs : trajectories_.critic_costs_)
+  {
+    if (costs[index] == dwa_planner::CostCritic::INFEASIBLE_COST)
+      return true;
+  }
+  return false;
 }
 
-std::vector<DWAPlanner::State> DWAPlanner::generate_trajectory(const double velocity, const double yawrate)
+void DWAPlanner::generate_trajectory(const double velocity, const double yawrate, std::vector<State> &trajectory)
 {
-  std::vector<State> trajectory;
-  trajectory.resize(sim_time_samples_);
-  State state;
-  for (int i = 0; i < sim_time_samples_; i++)
-  {
-    motion(state, velocity, yawrate);
-    trajectory[i] = state;
-  }
-  return trajectory;
+  rollout(velocity, yawrate, trajectory);
 }
 
-std::vector<DWAPlanner::State> DWAPlanner::generate_trajectory(const double yawrate, const Eigen::Vector3d &goal)
+void DWAPlanner::generate_trajectory(
+    const double yawrate, const Eigen::Vector3d &goal, std::vector<State> &trajectory)
 {
   const double target_direction = atan2(goal.y(), goal.x()) > 0 ? sim_direction_ : -sim_direction_;
   const double predict_time = target_direction / (yawrate + DBL_EPSILON);
-  std::vector<State> trajectory;
-  trajectory.resize(sim_time_samples_);
-  State state;
-  for (int i = 0; i < sim_time_samples_; i++)
-  {
-    motion(state, 0.0, yawrate);
-    trajectory[i] = state;
-  }
-  return trajectory;
+  rollout(0.0, yawrate, trajectory);
 }
 
-DWAPlanner::Cost DWAPlanner::evaluate_trajectory(const std::vector<State> &trajectory, const Eigen::Vector3d &goal)
+int DWAPlanner::add_trajectory(const std::vector<State> &trajectory)
 {
-  Cost cost;
-  cost.to_goal_cost_ = calc_to_goal_cost(trajectory, goal);
-  cost.obs_cost_ = calc_obs_cost(trajectory);
-  cost.speed_cost_ = calc_speed_cost(trajectory);
-  cost.path_cost_ = calc_path_cost(trajectory);
-  cost.calc_total_cost();
-  return cost;
+  const int index = trajectories_.add(
+      trajectory.front().velocity_, trajectory.front().yawrate_, trajectory.front().lateral_velocity_);
+  set_trajectory(index, trajectory);
+  return index;
 }
 
-geometry_msgs::Point DWAPlanner::calc_intersection(
-    const geometry_msgs::Point &obstacle, const State &state, geometry_msgs::PolygonStamped footprint)
+void DWAPlanner::set_trajectory(const int index, const std::vector<State> &trajectory)
 {
-  for (int i = 0; i < footprint.polygon.points.size(); i++)
+  float *x = trajectories_.x(index);
+  float *y = trajectories_.y(index);
+  float *yaw = trajectories_.yaw(index);
+  for (int i = 0; i < trajectories_.steps(); i++)
   {
-    const Eigen::Vector3d vector_A(obstacle.x, obstacle.y, 0.0);
-    const Eigen::Vector3d vector_B(state.x_, state.y_, 0.0);
-    const Eigen::Vector3d vector_C(footprint.polygon.points[i].x, footprint.polygon.points[i].y, 0.0);
-    Eigen::Vector3d vector_D(0.0, 0.0, 0.0);
-    if (i != footprint.polygon.points.size() - 1)
-      vector_D << footprint.polygon.points[i + 1].x, footprint.polygon.points[i + 1].y, 0.0;
-    else
-      vector_D << footprint.polygon.points[0].x, footprint.polygon.points[0].y, 0.0;
-
-    const double deno = (vector_B - vector_A).cross(vector_D - vector_C).z();
-    const double s = (vector_C - vector_A).cross(vector_D - vector_C).z() / deno;
-    const double t = (vector_B - vector_A).cross(vector_A - vector_C).z() / deno;
-
-    geometry_msgs::Point point;
-    point.x = vector_A.x() + s * (vector_B - vector_A).x();
-    point.y = vector_A.y() + s * (vector_B - vector_A).y();
-
-    // cross
-    if (!(s < 0.0 || 1.0 < s || t < 0.0 || 1.0 < t))
-      return point;
+    x[i] = trajectory[i].x_;
+    y[i] = trajectory[i].y_;
+    yaw[i] = trajectory[i].yaw_;
   }
+}
 
-  geometry_msgs::Point point;
-  point.x = 1e6;
-  point.y = 1e6;
-  return point;
+void DWAPlanner::set_trajectory(const int index, const float *x, const float *y, const float *yaw)
+{
+  std::copy(x, x + trajectories_.steps(), trajectories_.x(index));
+  std::copy(y, y + trajectories_.steps(), trajectories_.y(index));
+  std::copy(yaw, yaw + trajectories_.steps(), trajectories_.yaw(index));
 }
 
-float DWAPlanner::calc_dist_from_robot(const geometry_msgs::Point &obstacle, const State &state)
+void DWAPlanner::load_primitive_library(void)
 {
-  const geometry_msgs::PolygonStamped footprint = move_footprint(state);
-  if (is_inside_of_robot(obstacle, footprint, state))
+  if (!primitive_library_.load(primitive_library_path_))
   {
-    return 0.0;
+    ROS_ERROR_STREAM("Failed to load the primitive library " << primitive_library_path_);
+    return;
   }
-  else
+  // a library of another resolution would snap the commands of the planner to its grid, so it is not used either
+  if (primitive_library_.predict_time() != predict_time_ || primitive_library_.steps() != sim_time_samples_ ||
+      primitive_library_.resolution() != primitive_resolution_)
   {
-    geometry_msgs::Point intersection = calc_intersection(obstacle, state, footprint);
-    return hypot((obstacle.x - intersection.x), (obstacle.y - intersection.y));
+    ROS_WARN_STREAM(
+        "The primitive library " << primitive_library_path_ << " is generated for PREDICT_TIME: "
+                                 << primitive_library_.predict_time() << ", SIM_TIME_SAMPLES: "
+                                 << primitive_library_.steps() << " and PRIMITIVE_RESOLUTION: "
+                                 << primitive_library_.resolution() << ", so it is not used");
+    primitive_library_.unload();
+    return;
   }
+  ROS_INFO_STREAM("Loaded the primitive library " << primitive_library_path_);
 }
 
-geometry_msgs::PolygonStamped DWAPlanner::move_footprint(const State &target_pose)
+uint64_t DWAPlanner::calc_primitive_key(const double velocity, const double yawrate)
 {
-  geometry_msgs::PolygonStamped footprint;
-  if (use_footprint_)
-  {
-    footprint.header.frame_id = "base_link"; // Replace with your frame ID
-    footprint.header.stamp = ros::Time::now();
-
-    // Define the length and width of the rectangle
-    double length = 0.75;
-    double width = 0.5;
-
-    // Define the four corners of the rectangle
-    geometry_msgs::Point32 p1, p2, p3, p4;
-
-    // Bottom-left corner
-    p1.x = -length / 2.0;
-    p1.y = -width / 2.0;
-    p1.z = 0.0;
-
-    // Bottom-right corner
-    p2.x = length / 2.0;
-    p2.y = -width / 2.0;
-    p2.z = 0.0;
-
-    // Top-right corner
-    p3.x = length / 2.0;
-    p3.y = width / 2.0;
-    p3.z = 0.0;
+  const int32_t velocity_index = std::lround(velocity / primitive_resolution_);
+  const int32_t yawrate_index = std::lround(yawrate / primitive_resolution_);
+  return (static_cast<uint64_t>(static_cast<uint32_t>(velocity_index)) << 32) | static_cast<uint32_t>(yawrate_index);
+}
 
-    // Top-left corner
-    p4.x = -length / 2.0;
-    p4.y = width / 2.0;
-    p4.z = 0.0;
+void DWAPlanner::calc_primitive_velocity(const uint64_t key, double &velocity, double &yawrate)
+{
+  velocity = static_cast<int32_t>(key >> 32) * primitive_resolution_;
+  yawrate = static_cast<int32_t>(key & 0xffffffff) * primitive_resolution_;
+}
 
-    // Add the points to the polygon
-    footprint.polygon.points.push_back(p1);
-    footprint.polygon.points.push_back(p2);
-    footprint.polygon.points.push_back(p3);
-    footprint.polygon.points.push_back(p4);
-    footprint.polygon.points.push_back(p1); 
+const std::vector<DWAPlanner::State> &DWAPlanner::get_primitive(const uint64_t key)
+{
+  double velocity, yawrate;
+  calc_primitive_velocity(key, velocity, yawrate);
+  if (primitive_cache_size_ <= 0)
+  {
+    rollout(velocity, yawrate, primitive_);
+    return primitive_;
   }
-  else
+
+  // the primitives depend on the simulation parameters as well as the key
+  if (primitive_predict_time_ != predict_time_ || primitive_sim_time_samples_ != sim_time_samples_)
   {
-    const int plot_num = 20;
-    for (int i = 0; i < plot_num; i++)
-    {
-      geometry_msgs::Point32 point;
-      point.x = (robot_radius_ + footprint_padding_) * cos(2 * M_PI * i / plot_num);
-      point.y = robot_radius_ * sin(2 * M_PI * i / plot_num);
-      footprint.polygon.points.push_back(point);
-    }
+    primitive_cache_.clear();
+    primitive_cache_.set_capacity(primitive_cache_size_);
+    primitive_predict_time_ = predict_time_;
+    primitive_sim_time_samples_ = sim_time_samples_;
   }
+  if (const auto *primitive = primitive_cache_.find(key))
+    return *primitive;
 
-  footprint.header.stamp = ros::Time::now();
+  std::vector<State> &primitive = primitive_cache_.emplace(key);
+  rollout(velocity, yawrate, primitive);
+  return primitive;
+}
 
-  for (auto &point : footprint.polygon.points)
+void DWAPlanner::evaluate_trajectories(const int *indices, const int count)
+{
+  // the obstacle cost is left to the branch and bound, which skips it for most candidates
+  if (!use_branch_and_bound_)
+    obstacle_critic_.score(trajectories_, indices, count, trajectories_.obs_cost_.data());
+  to_goal_critic_.score(trajectories_, indices, count, trajectories_.to_goal_cost_.data());
+  if (use_speed_cost_)
+    speed_critic_.score(trajectories_, indices, count, trajectories_.speed_cost_.data());
+  if (use_path_cost_)
+    path_critic_.score(trajectories_, indices, count, trajectories_.path_cost_.data());
+  for (int k = 0; k < critics_.size(); k++)
+    critics_[k]->score(trajectories_, indices, count, trajectories_.critic_costs_[k].data());
+  for (int i = 0; i < count; i++)
+    candidate_evaluated_[indices[i]] = true;
+  if (use_branch_and_bound_)
+    return;
+  for (int i = 0; i < count; i++)
   {
-    Eigen::VectorXf point_in(2);
-    point_in << point.x, point.y;
-    Eigen::Matrix2f rot;
-    rot = Eigen::Rotation2Df(target_pose.yaw_);
-    const Eigen::VectorXf point_out = rot * point_in;
-
-    point.x = point_out.x() + target_pose.x_;
-    point.y = point_out.y() + target_pose.y_;
+    const int index = indices[i];
+    trajectories_.valid_[index] =
+        trajectories_.obs_cost_[index] != dwa_planner::CostCritic::INFEASIBLE_COST && !is_rejected_by_critics(index);
   }
+}
 
+geometry_msgs::PolygonStamped DWAPlanner::move_footprint(const State &target_pose)
+{
+  geometry_msgs::PolygonStamped footprint;
+  footprint.header.frame_id = robot_frame_;
+  footprint_cache_->transform(target_pose.x_, target_pose.y_, target_pose.yaw_, footprint.polygon);
   return footprint;
 }
 
-bool DWAPlanner::is_inside_of_robot(
-    const geometry_msgs::Point &obstacle, const geometry_msgs::PolygonStamped &footprint, const State &state)
+bool DWAPlanner::is_inside_of_robot(const geometry_msgs::Point &obstacle, const Eigen::Isometry2d &to_robot)
 {
-  geometry_msgs::Point32 state_point;
-  state_point.x = state.x_;
-  state_point.y = state.y_;
-
-  for (int i = 0; i < footprint.polygon.points.size(); i++)
-  {
-    geometry_msgs::Polygon triangle;
-    triangle.points.push_back(state_point);
-    triangle.points.push_back(footprint.polygon.points[i]);
-
-    if (i != footprint.polygon.points.size() - 1)
-      triangle.points.push_back(footprint.polygon.points[i + 1]);
-    else
-      triangle.points.push_back(footprint.polygon.points[0]);
+  return footprint_cache_->contains(to_robot * Eigen::Vector2d(obstacle.x, obstacle.y));
+}
 
-    if (is_inside_of_triangle(obstacle, triangle))
-      return true;
-  }
+Eigen::Isometry2d DWAPlanner::calc_transform_to_robot(const double x, const double y, const double yaw)
+{
+  return (Eigen::Translation2d(x, y) * Eigen::Rotation2Dd(yaw)).inverse();
+}
 
-  return false;
+void DWAPlanner::rollout(const double velocity, const double yawrate, std::vector<State> &trajectory)
+{
+  trajectory.resize(sim_time_samples_);
+  rollout_arc(
+      velocity, yawrate, predict_time_, sim_time_samples_,
+      [&](const int i, const double x, const double y, const double yaw)
+      {
+        State &state = trajectory[i];
+        state.x_ = x;
+        state.y_ = y;
+        state.yaw_ = yaw;
+        state.velocity_ = velocity;
+        state.yawrate_ = yawrate;
+        state.lateral_velocity_ = 0.0;
+      });
 }
 
-bool DWAPlanner::is_inside_of_triangle(const geometry_msgs::Point &target_point, const geometry_msgs::Polygon &triangle)
+void DWAPlanner::create_obs_list(const sensor_msgs::LaserScan &scan, geometry_msgs::PoseArray &obs_list)
 {
-  if (triangle.points.size() != 3)
+  obs_list.poses.clear();
+  const int angle_index_step = std::max(static_cast<int>(angle_resolution_ / scan.angle_increment), 1);
+  for (int i = 0; i < scan_converter_.x_.size(); i += angle_index_step)
   {
-    ROS_ERROR("Not triangle");
-    exit(1);
+    if (!scan_converter_.valid_[i])
+      continue;
+    geometry_msgs::Pose pose;
+    pose.position.x = scan_converter_.x_[i];
+    pose.position.y = scan_converter_.y_[i];
+    obs_list.poses.push_back(pose);
   }
+}
 
-  const Eigen::Vector3d vector_A(triangle.points[0].x, triangle.points[0].y, 0.0);
-  const Eigen::Vector3d vector_B(triangle.points[1].x, triangle.points[1].y, 0.0);
-  const Eigen::Vector3d vector_C(triangle.points[2].x, triangle.points[2].y, 0.0);
-  const Eigen::Vector3d vector_P(target_point.x, target_point.y, 0.0);
-
-  const Eigen::Vector3d vector_AB = vector_B - vector_A;
-  const Eigen::Vector3d vector_BP = vector_P - vector_B;
-  const Eigen::Vector3d cross1 = vector_AB.cross(vector_BP);
-
-  const Eigen::Vector3d vector_BC = vector_C - vector_B;
-  const Eigen::Vector3d vector_CP = vector_P - vector_C;
-  const Eigen::Vector3d cross2 = vector_BC.cross(vector_CP);
-
-  const Eigen::Vector3d vector_CA = vector_A - vector_C;
-  const Eigen::Vector3d vector_AP = vector_P - vector_A;
-  const Eigen::Vector3d cross3 = vector_CA.cross(vector_AP);
+void DWAPlanner::create_obs_list(const sensor_msgs::PointCloud2 &cloud, geometry_msgs::PoseArray &obs_list)
+{
+  if (!cloud_filter_.filter(
+          cloud, cloud_min_height_, cloud_max_height_, calc_obs_half_size(), cloud_voxel_size_, obs_list))
+    ROS_WARN_THROTTLE(1.0, "Cloud does not have float x, y and z fields");
+}
 
-  if ((0 < cross1.z() && 0 < cross2.z() && 0 < cross3.z()) || (cross1.z() < 0 && cross2.z() < 0 && cross3.z() < 0))
-    return true;
-  else
-    return false;
+double DWAPlanner::calc_obs_half_size(void)
+{
+  // obstacles farther than this from every reachable state never affect the obstacle cost
+  const double max_speed = use_holonomic_ ? hypot(max_velocity_, max_lateral_velocity_) : max_velocity_;
+  return max_speed * predict_time_ + obs_range_ + std::atomic_load(&footprint_cache_)->radius_;
 }
 
-void DWAPlanner::motion(State &state, const double velocity, const double yawrate)
+ObstacleSnapshot &DWAPlanner::acquire_obstacle_buffer(void)
 {
-  const double sim_time_step = predict_time_ / static_cast<double>(sim_time_samples_);
-  state.yaw_ += yawrate * sim_time_step;
-  state.x_ += velocity * std::cos(state.yaw_) * sim_time_step;
-  state.y_ += velocity * std::sin(state.yaw_) * sim_time_step;
-  state.velocity_ = velocity;
-  state.yawrate_ = yawrate;
+  // the snapshot last replaced is reused unless the planner still holds it
+  if (obstacle_buffer_ == nullptr || obstacle_buffer_.use_count() != 1)
+    obstacle_buffer_ = std::make_shared<ObstacleSnapshot>();
+  // pairs with the release of the planner dropping the snapshot, so that its reads happen before the writes here
+  std::atomic_thread_fence(std::memory_order_acquire);
+  obstacle_buffer_->footprint_ = std::atomic_load(&footprint_cache_);
+  return *obstacle_buffer_;
 }
 
-void DWAPlanner::create_obs_list(const sensor_msgs::LaserScan &scan)
+void DWAPlanner::publish_obstacle_buffer(void)
 {
-  obs_list_.poses.clear();
-  float angle = scan.angle_min;
-  const int angle_index_step = static_cast<int>(angle_resolution_ / scan.angle_increment);
-  for (int i = 0; i < scan.ranges.size(); i++)
+  update_obs_index(*obstacle_buffer_);
+  if (use_distance_field_)
+    update_distance_field(*obstacle_buffer_);
+  // the planner reads either the previous snapshot or this one as a whole, never a partly built one
+  const std::shared_ptr<const ObstacleSnapshot> previous =
+      std::atomic_exchange(&obstacle_snapshot_, std::shared_ptr<const ObstacleSnapshot>(obstacle_buffer_));
+  obstacle_buffer_ = std::const_pointer_cast<ObstacleSnapshot>(previous);
+  if (use_sensor_trigger_)
   {
-    const float r = scan.ranges[i];
-    if (r < scan.range_min || scan.range_max < r || i % angle_index_step != 0)
     {
-      angle += scan.angle_increment;
-      continue;
+      std::lock_guard<std::mutex> lock(trigger_mutex_);
+      has_new_obstacles_ = true;
     }
-    geometry_msgs::Pose pose;
-    pose.position.x = r * cos(angle);
-    pose.position.y = r * sin(angle);
-    obs_list_.poses.push_back(pose);
-    angle += scan.angle_increment;
+    trigger_cv_.notify_one();
   }
 }
 
-void DWAPlanner::create_obs_list(const nav_msgs::OccupancyGrid &map)
+void DWAPlanner::update_obs_index(ObstacleSnapshot &snapshot)
 {
-  obs_list_.poses.clear();
-  const double max_search_dist = hypot(map.info.origin.position.x, map.info.origin.position.y);
-  for (float angle = -M_PI; angle <= M_PI; angle += angle_resolution_)
-  {
-    for (float dist = 0.0; dist <= max_search_dist; dist += map.info.resolution)
-    {
-      geometry_msgs::Pose pose;
-      pose.position.x = dist * cos(angle);
-      pose.position.y = dist * sin(angle);
-      const int index_x = floor((pose.position.x - map.info.origin.position.x) / map.info.resolution);
-      const int index_y = floor((pose.position.y - map.info.origin.position.y) / map.info.resolution);
+  // about ten cells across the obstacle range keeps both the query and the build cheap
+  snapshot.obs_index_.build(snapshot.obs_list_, obs_range_ / 10.0, calc_obs_half_size());
+}
 
-      if ((0 <= index_x && index_x < map.info.width) && (0 <= index_y && index_y < map.info.height))
-      {
-        if (map.data[index_x + index_y * map.info.width] == 100)
-        {
-          obs_list_.poses.push_back(pose);
-          break;
-        }
-      }
-    }
+void DWAPlanner::update_distance_field(ObstacleSnapshot &snapshot)
+{
+  const double half_size = calc_obs_half_size();
+  if (use_footprint_)
+  {
+    geometry_msgs::Polygon footprint;
+    snapshot.footprint_->transform(0.0, 0.0, 0.0, footprint);
+    snapshot.configuration_space_.set_footprint(footprint, distance_field_resolution_, yaw_bins_);
+    snapshot.configuration_space_.reset(half_size);
+    for (const auto &obs : snapshot.obs_list_.poses)
+      snapshot.configuration_space_.add_obstacle(obs.position.x, obs.position.y);
+    snapshot.configuration_space_.compute();
+  }
+  else
+  {
+    snapshot.distance_field_.reset(distance_field_resolution_, half_size);
+    for (const auto &obs : snapshot.obs_list_.poses)
+      snapshot.distance_field_.add_obstacle(obs.position.x, obs.position.y);
+    snapshot.distance_field_.compute();
   }
 }
 
+void DWAPlanner::create_obs_list(const nav_msgs::OccupancyGrid &map, geometry_msgs::PoseArray &obs_list)
+{
+  ray_table_.update(map.info, angle_resolution_);
+  ray_table_.cast(map.data, ray_cast_threads_, obs_list);
+}
+
 visualization_msgs::Marker DWAPlanner::create_marker_msg(
-    const int id, const double scale, const std_msgs::ColorRGBA color, const std::vector<State> &trajectory,
-    const geometry_msgs::PolygonStamped &footprint)
+    const int id, const double scale, const std_msgs::ColorRGBA color, const TrajectoryStore &trajectories,
+    const int index, const geometry_msgs::PolygonStamped &footprint)
 {
   visualization_msgs::Marker marker;
   marker.header.frame_id = robot_frame_;
@@ -863,10 +1342,10 @@ visualization_msgs::Marker DWAPlanner::create_marker_msg(
   geometry_msgs::Point p;
   if (footprint.polygon.points.empty())
   {
-    for (const auto &point : trajectory)
+    for (int i = 0; i < trajectories.steps(); i++)
     {
-      p.x = point.x_;
-      p.y = point.y_;
+      p.x = trajectories.x(index)[i];
+      p.y = trajectories.y(index)[i];
       marker.points.push_back(p);
     }
   }
@@ -886,22 +1365,25 @@ visualization_msgs::Marker DWAPlanner::create_marker_msg(
   return marker;
 }
 
-void DWAPlanner::visualize_trajectory(const std::vector<State> &trajectory, const ros::Publisher &pub)
+void DWAPlanner::visualize_trajectory(const TrajectoryStore &trajectories, const int index, const ros::Publisher &pub)
 {
   std_msgs::ColorRGBA color;
   color.r = 1.0;
-  visualization_msgs::Marker v_trajectory = create_marker_msg(0, v_path_width_, color, trajectory);
+  visualization_msgs::Marker v_trajectory = create_marker_msg(0, v_path_width_, color, trajectories, index);
   pub.publish(v_trajectory);
 }
 
-void DWAPlanner::visualize_trajectories(
-    const std::vector<std::pair<std::vector<State>, bool>> &trajectories, const ros::Publisher &pub)
+void DWAPlanner::visualize_trajectories(const TrajectoryStore &trajectories, const ros::Publisher &pub)
 {
+  // the markers after the trajectories repeat the first one to overwrite the markers of a larger previous set
+  const int lateral_velocity_samples = use_holonomic_ ? lateral_velocity_samples_ + 1 : 1;
+  const int marker_num = trajectories.size() + velocity_samples_ * lateral_velocity_samples * (yawrate_samples_ + 1);
   visualization_msgs::MarkerArray v_trajectories;
-  for (int i = 0; i < trajectories.size(); i++)
+  for (int i = 0; i < marker_num; i++)
   {
+    const int index = i < trajectories.size() ? i : 0;
     std_msgs::ColorRGBA color;
-    if (trajectories[i].second)
+    if (trajectories.valid_[index])
     {
       color.g = 1.0;
     }
@@ -910,21 +1392,25 @@ void DWAPlanner::visualize_trajectories(
       color.r = 0.5;
       color.b = 0.5;
     }
-    visualization_msgs::Marker v_trajectory = create_marker_msg(i, v_path_width_ * 0.4, color, trajectories[i].first);
+    visualization_msgs::Marker v_trajectory = create_marker_msg(i, v_path_width_ * 0.4, color, trajectories, index);
     v_trajectories.markers.push_back(v_trajectory);
   }
   pub.publish(v_trajectories);
 }
 
-void DWAPlanner::visualize_footprints(const std::vector<State> &trajectory, const ros::Publisher &pub)
+void DWAPlanner::visualize_footprints(const TrajectoryStore &trajectories, const int index, const ros::Publisher &pub)
 {
   std_msgs::ColorRGBA color;
   color.b = 1.0;
   visualization_msgs::MarkerArray v_footprints;
-  for (int i = 0; i < trajectory.size(); i++)
+  for (int i = 0; i < trajectories.steps(); i++)
   {
-    const geometry_msgs::PolygonStamped footprint = move_footprint(trajectory[i]);
-    visualization_msgs::Marker v_footprint = create_marker_msg(i, v_path_width_ * 0.2, color, trajectory, footprint);
+    const State state(
+        trajectories.x(index)[i], trajectories.y(index)[i], trajectories.yaw(index)[i], trajectories.velocity_[index],
+        trajectories.yawrate_[index]);
+    const geometry_msgs::PolygonStamped footprint = move_footprint(state);
+    visualization_msgs::Marker v_footprint =
+        create_marker_msg(i, v_path_width_ * 0.2, color, trajectories, index, footprint);
     v_footprints.markers.push_back(v_footprint);
   }
   pub.publish(v_footprints);
@@ -0,0 +1,122 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "dwa_planner/convex_polygon.h"
+#include "dwa_planner/footprint.h"
+
+Footprint::Footprint(void) : radius_(0.0), padding_(0.0) {}
+
+bool Footprint::update(const geometry_msgs::Polygon &polygon, const double padding)
+{
+  std::vector<Eigen::Vector2d> source;
+  source.reserve(polygon.points.size());
+  for (const auto &point : polygon.points)
+  {
+    const Eigen::Vector2d vertex(point.x, point.y);
+    // drop repeated vertices including the closing one
+    if (source.empty() || !vertex.isApprox(source.back()))
+      source.push_back(vertex);
+  }
+  while (1 < source.size() && source.front().isApprox(source.back()))
+    source.pop_back();
+  if (!set_source(source, padding))
+    return false;
+
+  vertices_ = source_;
+  for (auto &vertex : vertices_)
+  {
+    vertex.x() += vertex.x() < 0 ? -padding_ : padding_;
+    vertex.y() += vertex.y() < 0 ? -padding_ : padding_;
+  }
+  // the obstacle checks need a convex footprint, so concave ones are replaced by their hulls
+  calc_convex_hull(vertices_);
+  rebuild();
+  return true;
+}
+
+bool Footprint::update(const double radius, const double padding)
+{
+  const int plot_num = 20;
+  std::vector<Eigen::Vector2d> source(plot_num);
+  for (int i = 0; i < plot_num; i++)
+    source[i] = radius * Eigen::Vector2d(cos(2 * M_PI * i / plot_num), sin(2 * M_PI * i / plot_num));
+  if (!set_source(source, padding))
+    return false;
+
+  // pad a circle radially
+  vertices_.resize(plot_num);
+  for (int i = 0; i < plot_num; i++)
+    vertices_[i] = (radius + padding_) * Eigen::Vector2d(cos(2 * M_PI * i / plot_num), sin(2 * M_PI * i / plot_num));
+  rebuild();
+  return true;
+}
+
+void Footprint::transform(const double x, const double y, const double yaw, std::vector<Eigen::Vector2d> &points) const
+{
+  const double c = cos(yaw);
+  const double s = sin(yaw);
+  points.resize(vertices_.size());
+  for (size_t i = 0; i < vertices_.size(); i++)
+  {
+    points[i].x() = c * vertices_[i].x() - s * vertices_[i].y() + x;
+    points[i].y() = s * vertices_[i].x() + c * vertices_[i].y() + y;
+  }
+}
+
+void Footprint::transform(const double x, const double y, const double yaw, geometry_msgs::Polygon &polygon) const
+{
+  const double c = cos(yaw);
+  const double s = sin(yaw);
+  polygon.points.resize(vertices_.size());
+  for (size_t i = 0; i < vertices_.size(); i++)
+  {
+    polygon.points[i].x = c * vertices_[i].x() - s * vertices_[i].y() + x;
+    polygon.points[i].y = s * vertices_[i].x() + c * vertices_[i].y() + y;
+    polygon.points[i].z = 0.0;
+  }
+}
+
+bool Footprint::contains(const Eigen::Vector2d &point) const
+{
+  return is_inside_of_convex_polygon(point, vertices_, edge_normals_);
+}
+
+double Footprint::signed_distance(const Eigen::Vector2d &point) const
+{
+  return calc_signed_distance_to_convex_polygon(point, vertices_, edge_normals_);
+}
+
+bool Footprint::set_source(const std::vector<Eigen::Vector2d> &source, const double padding)
+{
+  if (source == source_ && padding == padding_)
+    return false;
+  source_ = source;
+  padding_ = padding;
+  return true;
+}
+
+void Footprint::rebuild(void)
+{
+  double area = 0.0;
+  for (size_t i = 0; i < vertices_.size(); i++)
+  {
+    const Eigen::Vector2d &a = vertices_[i];
+    const Eigen::Vector2d &b = vertices_[(i + 1) % vertices_.size()];
+    area += a.x() * b.y() - b.x() * a.y();
+  }
+
+  // outward unit normals whatever the winding of the polygon is
+  edge_normals_.resize(vertices_.size());
+  radius_ = 0.0;
+  for (size_t i = 0; i < vertices_.size(); i++)
+  {
+    const Eigen::Vector2d edge = vertices_[(i + 1) % vertices_.size()] - vertices_[i];
+    const Eigen::Vector2d normal =
+        area < 0 ? Eigen::Vector2d(-edge.y(), edge.x()) : Eigen::Vector2d(edge.y(), -edge.x());
+    edge_normals_[i] = normal.normalized();
+    radius_ = std::max(radius_, vertices_[i].norm());
+  }
+}
@@ -0,0 +1,146 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "dwa_planner/min_distance.h"
+
+namespace
+{
+/**
+ * @brief The arguments shared by the distance kernels
+ */
+struct Batch
+{
+  const float *state_x;
+  const float *state_y;
+  int state_num;
+  const float *obs_x;
+  const float *obs_y;
+  int obs_num;
+  float collision_sq_dist;
+};
+
+/**
+ * @brief Lower the minimum with the obstacles from begin to the end of a state one by one
+ */
+float calc_min_scalar(const Batch &batch, const float x, const float y, const int begin, float min_sq_dist)
+{
+  for (int i = begin; i < batch.obs_num; i++)
+  {
+    const float dx = x - batch.obs_x[i];
+    const float dy = y - batch.obs_y[i];
+    min_sq_dist = std::min(min_sq_dist, dx * dx + dy * dy);
+  }
+  return min_sq_dist;
+}
+
+/**
+ * @brief Calculate state by state with the scalar loop
+ */
+bool calc_scalar(const Batch &batch, float &min_sq_dist)
+{
+  for (int s = 0; s < batch.state_num; s++)
+  {
+    min_sq_dist = calc_min_scalar(batch, batch.state_x[s], batch.state_y[s], 0, min_sq_dist);
+    if (min_sq_dist < batch.collision_sq_dist)
+      return true;
+  }
+  return false;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Calculate eight obstacles at a time
+ */
+__attribute__((target("avx2"))) bool calc_avx2(const Batch &batch, float &min_sq_dist)
+{
+  for (int s = 0; s < batch.state_num; s++)
+  {
+    const __m256 x = _mm256_set1_ps(batch.state_x[s]);
+    const __m256 y = _mm256_set1_ps(batch.state_y[s]);
+    __m256 min = _mm256_set1_ps(min_sq_dist);
+    int i = 0;
+    for (; i + 8 <= batch.obs_num; i += 8)
+    {
+      const __m256 dx = _mm256_sub_ps(x, _mm256_loadu_ps(batch.obs_x + i));
+      const __m256 dy = _mm256_sub_ps(y, _mm256_loadu_ps(batch.obs_y + i));
+      min = _mm256_min_ps(min, _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+    }
+    __m128 half = _mm_min_ps(_mm256_castps256_ps128(min), _mm256_extractf128_ps(min, 1));
+    half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+    min_sq_dist = calc_min_scalar(batch, batch.state_x[s], batch.state_y[s], i, _mm_cvtss_f32(half));
+    if (min_sq_dist < batch.collision_sq_dist)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Calculate sixteen obstacles at a time, masking the tail
+ */
+__attribute__((target("avx512f"))) bool calc_avx512(const Batch &batch, float &min_sq_dist)
+{
+  for (int s = 0; s < batch.state_num; s++)
+  {
+    const __m512 x = _mm512_set1_ps(batch.state_x[s]);
+    const __m512 y = _mm512_set1_ps(batch.state_y[s]);
+    __m512 min = _mm512_set1_ps(min_sq_dist);
+    for (int i = 0; i < batch.obs_num; i += 16)
+    {
+      const __mmask16 mask = batch.obs_num - i < 16 ? (1u << (batch.obs_num - i)) - 1 : 0xffff;
+      const __m512 dx = _mm512_sub_ps(x, _mm512_maskz_loadu_ps(mask, batch.obs_x + i));
+      const __m512 dy = _mm512_sub_ps(y, _mm512_maskz_loadu_ps(mask, batch.obs_y + i));
+      min = _mm512_mask_min_ps(min, mask, min, _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)));
+    }
+    min_sq_dist = _mm512_reduce_min_ps(min);
+    if (min_sq_dist < batch.collision_sq_dist)
+      return true;
+  }
+  return false;
+}
+#endif
+}  // namespace
+
+bool is_supported(const MinDistanceKernel kernel)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  static const bool has_avx512 = __builtin_cpu_supports("avx512f");
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  if (kernel == MinDistanceKernel::AVX512)
+    return has_avx512;
+  if (kernel == MinDistanceKernel::AVX2)
+    return has_avx2;
+#endif
+  return kernel == MinDistanceKernel::SCALAR;
+}
+
+bool calc_min_squared_distance(
+    const MinDistanceKernel kernel, const float *state_x, const float *state_y, const int state_num,
+    const float *obs_x, const float *obs_y, const int obs_num, const float collision_sq_dist, float &min_sq_dist)
+{
+  const Batch batch = {state_x, state_y, state_num, obs_x, obs_y, obs_num, collision_sq_dist};
+#if defined(__x86_64__) || defined(__i386__)
+  if (kernel == MinDistanceKernel::AVX512)
+    return calc_avx512(batch, min_sq_dist);
+  if (kernel == MinDistanceKernel::AVX2)
+    return calc_avx2(batch, min_sq_dist);
+#endif
+  return calc_scalar(batch, min_sq_dist);
+}
+
+bool calc_min_squared_distance(
+    const float *state_x, const float *state_y, const int state_num, const float *obs_x, const float *obs_y,
+    const int obs_num, const float collision_sq_dist, float &min_sq_dist)
+{
+  static const MinDistanceKernel kernel = is_supported(MinDistanceKernel::AVX512) ? MinDistanceKernel::AVX512
+                                          : is_supported(MinDistanceKernel::AVX2) ? MinDistanceKernel::AVX2
+                                                                                  : MinDistanceKernel::SCALAR;
+  return calc_min_squared_distance(
+      kernel, state_x, state_y, state_num, obs_x, obs_y, obs_num, collision_sq_dist, min_sq_dist);
+}
@@ -0,0 +1,103 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "dwa_planner/obstacle_index.h"
+
+ObstacleIndex::ObstacleIndex(void)
+    : cell_size_(0.25), origin_x_(0.0), origin_y_(0.0), size_x_(0), size_y_(0), cell_begin_(1, 0)
+{
+}
+
+void ObstacleIndex::build(const geometry_msgs::PoseArray &obs_list, const double cell_size, const double half_size)
+{
+  cell_size_ = cell_size;
+  x_.clear();
+  y_.clear();
+  index_.clear();
+
+  float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+  for (int i = 0; i < obs_list.poses.size(); i++)
+  {
+    const geometry_msgs::Point &position = obs_list.poses[i].position;
+    if (half_size < fabs(position.x) || half_size < fabs(position.y))
+      continue;
+    x_.push_back(position.x);
+    y_.push_back(position.y);
+    index_.push_back(i);
+    min_x = std::min(min_x, x_.back());
+    min_y = std::min(min_y, y_.back());
+    max_x = std::max(max_x, x_.back());
+    max_y = std::max(max_y, y_.back());
+  }
+  if (x_.empty())
+  {
+    size_x_ = size_y_ = 0;
+    cell_begin_.assign(1, 0);
+    return;
+  }
+
+  origin_x_ = min_x;
+  origin_y_ = min_y;
+  size_x_ = to_cell(max_x, origin_x_) + 1;
+  size_y_ = to_cell(max_y, origin_y_) + 1;
+
+  // bucket the obstacles by cell
+  cell_begin_.assign(size_x_ * size_y_ + 1, 0);
+  cell_.resize(x_.size());
+  for (size_t i = 0; i < x_.size(); i++)
+  {
+    cell_[i] = to_cell(x_[i], origin_x_) + to_cell(y_[i], origin_y_) * size_x_;
+    cell_begin_[cell_[i] + 1]++;
+  }
+  for (size_t i = 1; i < cell_begin_.size(); i++)
+    cell_begin_[i] += cell_begin_[i - 1];
+
+  const std::vector<float> x = x_;
+  const std::vector<float> y = y_;
+  const std::vector<int> index = index_;
+  for (size_t i = 0; i < x.size(); i++)
+  {
+    const int slot = cell_begin_[cell_[i]]++;
+    x_[slot] = x[i];
+    y_[slot] = y[i];
+    index_[slot] = index[i];
+  }
+  for (size_t i = cell_begin_.size() - 1; 0 < i; i--)
+    cell_begin_[i] = cell_begin_[i - 1];
+  cell_begin_[0] = 0;
+}
+
+float ObstacleIndex::nearest_distance(const double x, const double y, const double max_dist) const
+{
+  if (size_x_ == 0)
+    return FLT_MAX;
+
+  // search rings of cells around the position until they are farther than the nearest obstacle found
+  const int center_x = to_cell(x, origin_x_);
+  const int center_y = to_cell(y, origin_y_);
+  const int max_ring = static_cast<int>(std::ceil(max_dist / cell_size_)) + 1;
+  float min_dist = FLT_MAX;
+  for (int ring = 0; ring <= max_ring; ring++)
+  {
+    if (std::min(static_cast<double>(min_dist), max_dist) < (ring - 1) * cell_size_)
+      break;
+    for (int iy = std::max(center_y - ring, 0); iy <= std::min(center_y + ring, size_y_ - 1); iy++)
+    {
+      const bool is_edge_row = abs(iy - center_y) == ring;
+      const int step = is_edge_row ? 1 : 2 * ring;
+      for (int ix = center_x - ring; ix <= center_x + ring; ix += std::max(step, 1))
+      {
+        if (ix < 0 || size_x_ <= ix)
+          continue;
+        const int cell = ix + iy * size_x_;
+        for (int i = cell_begin_[cell]; i < cell_begin_[cell + 1]; i++)
+          min_dist = std::min(min_dist, static_cast<float>(hypot(x - x_[i], y - y_[i])));
+      }
+    }
+  }
+  return min_dist <= max_dist ? min_dist : FLT_MAX;
+}
@@ -2,14 +2,45 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "dwa_planner/dwa_planner.h"
 
+namespace
+{
+/**
+ * @brief Replace the value of parameter with the default if it is not positive
+ * @param name The name of parameter
+ * @param value The value of parameter
+ * @param default_value The default of parameter
+ */
+template <class T>
+void ensure_positive(const std::string &name, T &value, const T default_value)
+{
+  if (0 < value)
+    return;
+  ROS_ERROR_STREAM(name << " (" << value << ") must be positive, " << name << " is set to " << default_value);
+  value = default_value;
+}
+}  // namespace
+
 void DWAPlanner::load_params(void)
 {
   // - A -
+  local_nh_.param<int>("ADAPTIVE_SAMPLING_BUDGET", adaptive_sampling_budget_, 200);
+  local_nh_.param<int>("ADAPTIVE_SAMPLING_CELLS", adaptive_sampling_cells_, 3);
+  local_nh_.param<int>("ADAPTIVE_SAMPLING_LEVELS", adaptive_sampling_levels_, 0);
   local_nh_.param<double>("ANGLE_RESOLUTION", angle_resolution_, 0.087);
   local_nh_.param<double>("ANGLE_TO_GOAL_TH", angle_to_goal_th_, M_PI);
+  // - C -
+  local_nh_.param<double>("CLOUD_MAX_HEIGHT", cloud_max_height_, 1.0);
+  local_nh_.param<double>("CLOUD_MIN_HEIGHT", cloud_min_height_, 0.1);
+  local_nh_.param<double>("CLOUD_VOXEL_SIZE", cloud_voxel_size_, 0.05);
+  local_nh_.param<std::vector<std::string>>("CRITICS", critic_names_, std::vector<std::string>());
+  // - D -
+  local_nh_.param<double>("DISTANCE_FIELD_RESOLUTION", distance_field_resolution_, 0.05);
+  // - E -
+  local_nh_.param<int>("EVALUATION_THREADS", evaluation_threads_, 1);
   // - F -
   local_nh_.param<double>("FOOTPRINT_PADDING", footprint_padding_, 0.01);
   // - G -
@@ -17,11 +48,15 @@ void DWAPlanner::load_params(void)
   local_nh_.param<double>("GOAL_THRESHOLD", dist_to_goal_th_, 0.1);
   // - H -
   local_nh_.param<double>("HZ", hz_, 20);
+  // - L -
+  local_nh_.param<int>("LATERAL_VELOCITY_SAMPLES", lateral_velocity_samples_, 3);
   // - M -
   local_nh_.param<double>("MAX_ACCELERATION", max_acceleration_, 0.5);
   local_nh_.param<double>("MAX_DECELERATION", max_deceleration_, 2.0);
   local_nh_.param<double>("MAX_D_YAWRATE", max_d_yawrate_, 3.2);
   local_nh_.param<double>("MAX_IN_PLACE_YAWRATE", max_in_place_yawrate_, 0.6);
+  local_nh_.param<double>("MAX_HZ", max_hz_, 50);
+  local_nh_.param<double>("MAX_LATERAL_VELOCITY", max_lateral_velocity_, 0.5);
   local_nh_.param<double>("MAX_VELOCITY", max_velocity_, 1.0);
   local_nh_.param<double>("MAX_YAWRATE", max_yawrate_, 1.0);
   local_nh_.param<double>("MIN_IN_PLACE_YAWRATE", min_in_place_yawrate_, 0.3);
@@ -31,9 +66,15 @@ void DWAPlanner::load_params(void)
   local_nh_.param<double>("OBSTACLE_COST_GAIN", obs_cost_gain_, 1.0);
   local_nh_.param<double>("OBS_RANGE", obs_range_, 2.5);
   // - P -
+  local_nh_.param<double>("PATH_COST_BOUND", path_cost_bound_, 1.0);
   local_nh_.param<double>("PATH_COST_GAIN", path_cost_gain_, 0.4);
+  local_nh_.param<double>("PLANNING_DEADLINE_RATIO", planning_deadline_ratio_, 0.0);
   local_nh_.param<double>("PREDICT_TIME", predict_time_, 3.0);
+  local_nh_.param<int>("PRIMITIVE_CACHE_SIZE", primitive_cache_size_, 1024);
+  local_nh_.param<std::string>("PRIMITIVE_LIBRARY", primitive_library_path_, std::string(""));
+  local_nh_.param<double>("PRIMITIVE_RESOLUTION", primitive_resolution_, 0.001);
   // - R -
+  local_nh_.param<int>("RAY_CAST_THREADS", ray_cast_threads_, 1);
   local_nh_.param<std::string>("ROBOT_FRAME", robot_frame_, std::string("base_link"));
   local_nh_.param<double>("ROBOT_RADIUS", robot_radius_, 0.1);
   // - S -
@@ -46,26 +87,62 @@ void DWAPlanner::load_params(void)
   local_nh_.param<int>("SUBSCRIBE_COUNT_TH", subscribe_count_th_, 3);
   // - T -
   local_nh_.param<double>("TARGET_VELOCITY", target_velocity_, 0.55);
+  local_nh_.param<double>("TO_GOAL_COST_BOUND", to_goal_cost_bound_, 3.0);
   local_nh_.param<double>("TO_GOAL_COST_GAIN", to_goal_cost_gain_, 0.8);
   local_nh_.param<double>("TURN_DIRECTION_THRESHOLD", turn_direction_th_, 0.1);
   // - U -
+  local_nh_.param<bool>("USE_BRANCH_AND_BOUND", use_branch_and_bound_, false);
+  local_nh_.param<bool>("USE_CLOUD_AS_INPUT", use_cloud_as_input_, false);
+  local_nh_.param<bool>("USE_DISTANCE_FIELD", use_distance_field_, false);
   local_nh_.param<bool>("USE_FOOTPRINT", use_footprint_, false);
+  local_nh_.param<bool>("USE_HOLONOMIC", use_holonomic_, false);
   local_nh_.param<bool>("USE_PATH_COST", use_path_cost_, false);
   local_nh_.param<bool>("USE_SCAN_AS_INPUT", use_scan_as_input_, false);
+  local_nh_.param<bool>("USE_SENSOR_THREAD", use_sensor_thread_, false);
+  local_nh_.param<bool>("USE_SENSOR_TRIGGER", use_sensor_trigger_, false);
   // - V -
   local_nh_.param<int>("VELOCITY_SAMPLES", velocity_samples_, 3);
   local_nh_.param<double>("V_PATH_WIDTH", v_path_width_, 0.05);
   // - Y -
   local_nh_.param<int>("YAWRATE_SAMPLES", yawrate_samples_, 20);
+  local_nh_.param<int>("YAW_BINS", yaw_bins_, 16);
 
   target_velocity_ = std::min(target_velocity_, max_velocity_);
+  if (use_sensor_trigger_ && max_hz_ < hz_)
+  {
+    ROS_ERROR_STREAM("MAX_HZ (" << max_hz_ << ") is lower than HZ (" << hz_ << "), MAX_HZ is set to HZ");
+    max_hz_ = hz_;
+  }
+  // the planner divides by these values or runs this many threads
+  ensure_positive("ANGLE_RESOLUTION", angle_resolution_, 0.087);
+  ensure_positive("CLOUD_VOXEL_SIZE", cloud_voxel_size_, 0.05);
+  ensure_positive("DISTANCE_FIELD_RESOLUTION", distance_field_resolution_, 0.05);
+  ensure_positive("EVALUATION_THREADS", evaluation_threads_, 1);
+  ensure_positive("PRIMITIVE_RESOLUTION", primitive_resolution_, 0.001);
+  ensure_positive("RAY_CAST_THREADS", ray_cast_threads_, 1);
+  ensure_positive("YAW_BINS", yaw_bins_, 16);
 }
 
 void DWAPlanner::print_params(void)
 {
   // - A -
+  ROS_INFO_STREAM("ADAPTIVE_SAMPLING_BUDGET: " << adaptive_sampling_budget_);
+  ROS_INFO_STREAM("ADAPTIVE_SAMPLING_CELLS: " << adaptive_sampling_cells_);
+  ROS_INFO_STREAM("ADAPTIVE_SAMPLING_LEVELS: " << adaptive_sampling_levels_);
   ROS_INFO_STREAM("ANGLE_RESOLUTION: " << angle_resolution_);
   ROS_INFO_STREAM("ANGLE_TO_GOAL_TH: " << angle_to_goal_th_);
+  // - C -
+  ROS_INFO_STREAM("CLOUD_MAX_HEIGHT: " << cloud_max_height_);
+  ROS_INFO_STREAM("CLOUD_MIN_HEIGHT: " << cloud_min_height_);
+  ROS_INFO_STREAM("CLOUD_VOXEL_SIZE: " << cloud_voxel_size_);
+  std::string critic_names;
+  for (const auto &name : critic_names_)
+    critic_names += (critic_names.empty() ? "" : ", ") + name;
+  ROS_INFO_STREAM("CRITICS: [" << critic_names << "]");
+  // - D -
+  ROS_INFO_STREAM("DISTANCE_FIELD_RESOLUTION: " << distance_field_resolution_);
+  // - E -
+  ROS_INFO_STREAM("EVALUATION_THREADS: " << evaluation_threads_);
   // - F -
   ROS_INFO_STREAM("FOOTPRINT_PADDING: " << footprint_padding_);
   // - G -
@@ -73,11 +150,15 @@ void DWAPlanner::print_params(void)
   ROS_INFO_STREAM("GOAL_THRESHOLD: " << dist_to_goal_th_);
   // - H -
   ROS_INFO_STREAM("HZ: " << hz_);
+  // - L -
+  ROS_INFO_STREAM("LATERAL_VELOCITY_SAMPLES: " << lateral_velocity_samples_);
   // - M -
   ROS_INFO_STREAM("MAX_ACCELERATION: " << max_acceleration_);
   ROS_INFO_STREAM("MAX_DECELERATION: " << max_deceleration_);
   ROS_INFO_STREAM("MAX_D_YAWRATE: " << max_d_yawrate_);
   ROS_INFO_STREAM("MAX_IN_PLACE_YAWRATE: " << max_in_place_yawrate_);
+  ROS_INFO_STREAM("MAX_HZ: " << max_hz_);
+  ROS_INFO_STREAM("MAX_LATERAL_VELOCITY: " << max_lateral_velocity_);
   ROS_INFO_STREAM("MAX_VELOCITY: " << max_velocity_);
   ROS_INFO_STREAM("MAX_YAWRATE: " << max_yawrate_);
   ROS_INFO_STREAM("MIN_IN_PLACE_YAWRATE: " << min_in_place_yawrate_);
@@ -87,9 +168,15 @@ void DWAPlanner::print_params(void)
   ROS_INFO_STREAM("OBSTACLE_COST_GAIN: " << obs_cost_gain_);
   ROS_INFO_STREAM("OBS_RANGE: " << obs_range_);
   // - P -
+  ROS_INFO_STREAM("PATH_COST_BOUND: " << path_cost_bound_);
   ROS_INFO_STREAM("PATH_COST_GAIN: " << path_cost_gain_);
+  ROS_INFO_STREAM("PLANNING_DEADLINE_RATIO: " << planning_deadline_ratio_);
   ROS_INFO_STREAM("PREDICT_TIME: " << predict_time_);
+  ROS_INFO_STREAM("PRIMITIVE_CACHE_SIZE: " << primitive_cache_size_);
+  ROS_INFO_STREAM("PRIMITIVE_LIBRARY: " << primitive_library_path_);
+  ROS_INFO_STREAM("PRIMITIVE_RESOLUTION: " << primitive_resolution_);
   // - R -
+  ROS_INFO_STREAM("RAY_CAST_THREADS: " << ray_cast_threads_);
   ROS_INFO_STREAM("ROBOT_FRAME: " << robot_frame_);
   ROS_INFO_STREAM("ROBOT_RADIUS: " << robot_radius_);
   // - S -
@@ -102,15 +189,23 @@ void DWAPlanner::print_params(void)
   ROS_INFO_STREAM("SUBSCRIBE_COUNT_TH: " << subscribe_count_th_);
   // - T -
   ROS_INFO_STREAM("TARGET_VELOCITY: " << target_velocity_);
+  ROS_INFO_STREAM("TO_GOAL_COST_BOUND: " << to_goal_cost_bound_);
   ROS_INFO_STREAM("TO_GOAL_COST_GAIN: " << to_goal_cost_gain_);
   ROS_INFO_STREAM("TURN_DIRECTION_THRESHOLD: " << turn_direction_th_);
   // - U -
+  ROS_INFO_STREAM("USE_BRANCH_AND_BOUND: " << use_branch_and_bound_);
+  ROS_INFO_STREAM("USE_CLOUD_AS_INPUT: " << use_cloud_as_input_);
+  ROS_INFO_STREAM("USE_DISTANCE_FIELD: " << use_distance_field_);
   ROS_INFO_STREAM("USE_FOOTPRINT: " << use_footprint_);
+  ROS_INFO_STREAM("USE_HOLONOMIC: " << use_holonomic_);
   ROS_INFO_STREAM("USE_PATH_COST: " << use_path_cost_);
   ROS_INFO_STREAM("USE_SCAN_AS_INPUT: " << use_scan_as_input_);
+  ROS_INFO_STREAM("USE_SENSOR_THREAD: " << use_sensor_thread_);
+  ROS_INFO_STREAM("USE_SENSOR_TRIGGER: " << use_sensor_trigger_);
   // - V -
   ROS_INFO_STREAM("VELOCITY_SAMPLES: " << velocity_samples_);
   ROS_INFO_STREAM("V_PATH_WIDTH: " << v_path_width_);
   // - Y -
   ROS_INFO_STREAM("YAWRATE_SAMPLES: " << yawrate_samples_);
+  ROS_INFO_STREAM("YAW_BINS: " << yaw_bins_);
 }
@@ -0,0 +1,95 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "dwa_planner/path_distance.h"
+
+PathDistance::PathDistance(void) : center_(Eigen::Vector2d::Zero()), has_grid_(false) {}
+
+void PathDistance::set_path(const Eigen::Matrix2Xd &vertices)
+{
+  vertices_ = vertices;
+  has_grid_ = false;
+}
+
+bool PathDistance::update(const Eigen::Vector2d &robot, const double resolution, const double reach)
+{
+  // the states within the reach of the robot stay inside of the grid while this holds
+  if (empty() || (has_grid_ && (robot - center_).lpNorm<Eigen::Infinity>() <= -field_.origin_ - reach))
+    return false;
+  // twice the reach, so the grid is built again only after the robot moves by the reach
+  center_ = robot;
+  field_.reset(resolution, 2.0 * reach);
+  // samples at the cell spacing keep the distance to the samples within about one cell of the distance to the path
+  field_.add_obstacle(vertices_(0, 0) - center_.x(), vertices_(1, 0) - center_.y());
+  for (int i = 1; i < vertices_.cols(); i++)
+    add_segment(vertices_.col(i - 1) - center_, vertices_.col(i) - center_, resolution);
+  field_.compute();
+  has_grid_ = true;
+  return true;
+}
+
+void PathDistance::add_segment(const Eigen::Vector2d &begin, const Eigen::Vector2d &end, const double resolution)
+{
+  // clip the segment to the grid, so a long path costs no more than the part of it near the robot
+  const Eigen::Vector2d direction = end - begin;
+  const double half_size = -field_.origin_;
+  double t_min = 0.0;
+  double t_max = 1.0;
+  for (int axis = 0; axis < 2; axis++)
+  {
+    if (fabs(direction[axis]) < DBL_EPSILON)
+    {
+      if (half_size < fabs(begin[axis]))
+        return;
+      continue;
+    }
+    const double t0 = (-half_size - begin[axis]) / direction[axis];
+    const double t1 = (half_size - begin[axis]) / direction[axis];
+    t_min = std::max(t_min, std::min(t0, t1));
+    t_max = std::min(t_max, std::max(t0, t1));
+  }
+  if (t_max < t_min)
+    return;
+  const int samples = std::max(static_cast<int>(std::ceil((t_max - t_min) * direction.norm() / resolution)), 1);
+  // the beginning of the path or of the segment was sampled with the previous segment unless it was clipped
+  for (int k = t_min == 0.0 ? 1 : 0; k <= samples; k++)
+  {
+    const Eigen::Vector2d sample = begin + direction * (t_min + (t_max - t_min) * k / samples);
+    field_.add_obstacle(sample.x(), sample.y());
+  }
+}
+
+float PathDistance::distance(const double x, const double y) const
+{
+  if (empty())
+    return 0.0;
+  const double grid_x = x - center_.x();
+  const double grid_y = y - center_.y();
+  if (has_grid_ && field_.contains(grid_x, grid_y))
+  {
+    // the path outside of the grid is at least as far as the border of the grid
+    const float dist = field_.distance(grid_x, grid_y);
+    const double dist_to_border = -field_.origin_ - std::max(fabs(grid_x), fabs(grid_y));
+    if (dist <= dist_to_border)
+      return dist;
+  }
+  return calc_segment_distance(x, y);
+}
+
+float PathDistance::calc_segment_distance(const double x, const double y) const
+{
+  const Eigen::Vector2d point(x, y);
+  double min_dist = (point - vertices_.col(0)).norm();
+  for (int i = 1; i < vertices_.cols(); i++)
+  {
+    const Eigen::Vector2d begin = vertices_.col(i - 1);
+    const Eigen::Vector2d segment = vertices_.col(i) - begin;
+    const double t =
+        std::min(std::max((point - begin).dot(segment) / std::max(segment.squaredNorm(), DBL_EPSILON), 0.0), 1.0);
+    min_dist = std::min(min_dist, (point - (begin + t * segment)).norm());
+  }
+  return min_dist;
+}
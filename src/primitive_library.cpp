@@ -0,0 +1,143 @@
+// Copyright 2020 amsl
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "dwa_planner/primitive_library.h"
+
+namespace
+{
+const char MAGIC[8] = "DWAPRIM";
+}  // namespace
+
+PrimitiveLibrary::PrimitiveLibrary(void) : header_(nullptr), states_(nullptr), data_(nullptr), size_(0) {}
+
+PrimitiveLibrary::~PrimitiveLibrary(void) { unload(); }
+
+bool PrimitiveLibrary::make_header(
+    const double predict_time, const int steps, const double resolution, const double min_velocity,
+    const double max_velocity, const double max_yawrate, Header &header)
+{
+  if (steps <= 0 || resolution <= 0.0 || max_velocity < min_velocity || max_yawrate < 0.0)
+    return false;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(header.magic));
+  header.version = VERSION;
+  header.steps = steps;
+  header.predict_time = predict_time;
+  header.resolution = resolution;
+  header.min_velocity_index = std::lround(min_velocity / resolution);
+  header.velocity_count = std::lround(max_velocity / resolution) - header.min_velocity_index + 1;
+  header.min_yawrate_index = -std::lround(max_yawrate / resolution);
+  header.yawrate_count = -2 * header.min_yawrate_index + 1;
+  return true;
+}
+
+size_t PrimitiveLibrary::calc_file_size(
+    const int steps, const double resolution, const double min_velocity, const double max_velocity,
+    const double max_yawrate, size_t &count)
+{
+  Header header;
+  count = 0;
+  if (!make_header(0.0, steps, resolution, min_velocity, max_velocity, max_yawrate, header))
+    return 0;
+  count = static_cast<size_t>(header.velocity_count) * header.yawrate_count;
+  return sizeof(Header) + count * 3 * steps * sizeof(float);
+}
+
+bool PrimitiveLibrary::generate(
+    const std::string &path, const double predict_time, const int steps, const double resolution,
+    const double min_velocity, const double max_velocity, const double max_yawrate)
+{
+  Header header;
+  if (!make_header(predict_time, steps, resolution, min_velocity, max_velocity, max_yawrate, header))
+    return false;
+
+  FILE *file = fopen(path.c_str(), "wb");
+  if (file == nullptr)
+    return false;
+  bool succeeded = fwrite(&header, sizeof(header), 1, file) == 1;
+  std::vector<float> states(3 * steps);
+  for (int i = 0; i < header.velocity_count && succeeded; i++)
+  {
+    // the same snapped values as the keys of the planner
+    const double velocity = (header.min_velocity_index + i) * resolution;
+    for (int j = 0; j < header.yawrate_count && succeeded; j++)
+    {
+      const double yawrate = (header.min_yawrate_index + j) * resolution;
+      rollout_arc(
+          velocity, yawrate, predict_time, steps,
+          [&](const int k, const double x, const double y, const double yaw)
+          {
+            states[k] = x;
+            states[steps + k] = y;
+            states[2 * steps + k] = yaw;
+          });
+      succeeded = fwrite(states.data(), sizeof(float), states.size(), file) == states.size();
+    }
+  }
+  return fclose(file) == 0 && succeeded;
+}
+
+bool PrimitiveLibrary::load(const std::string &path)
+{
+  unload();
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(Header)))
+  {
+    close(fd);
+    return false;
+  }
+  void *data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // the mapping stays valid after the file is closed
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  const Header *header = static_cast<const Header *>(data);
+  const size_t state_count = static_cast<size_t>(header->velocity_count) * header->yawrate_count * 3 * header->steps;
+  if (memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 || header->version != VERSION ||
+      header->steps == 0 || header->velocity_count <= 0 || header->yawrate_count <= 0 ||
+      static_cast<size_t>(file_stat.st_size) != sizeof(Header) + state_count * sizeof(float))
+  {
+    munmap(data, file_stat.st_size);
+    return false;
+  }
+  data_ = data;
+  size_ = file_stat.st_size;
+  header_ = header;
+  states_ = reinterpret_cast<const float *>(header + 1);
+  return true;
+}
+
+void PrimitiveLibrary::unload(void)
+{
+  if (data_ != nullptr)
+    munmap(data_, size_);
+  header_ = nullptr;
+  states_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+}
+
+int PrimitiveLibrary::find(const int32_t velocity_index, const int32_t yawrate_index) const
+{
+  if (header_ == nullptr)
+    return -1;
+  const int64_t i = static_cast<int64_t>(velocity_index) - header_->min_velocity_index;
+  const int64_t j = static_cast<int64_t>(yawrate_index) - header_->min_yawrate_index;
+  if (i < 0 || header_->velocity_count <= i || j < 0 || header_->yawrate_count <= j)
+    return -1;
+  return i * header_->yawrate_count + j;
+}
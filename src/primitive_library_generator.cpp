@@ -0,0 +1,46 @@
+// Copyright 2020 amsl
+
+#include <ros/ros.h>
+#include <string>
+
+#include "dwa_planner/primitive_library.h"
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "primitive_library_generator");
+  ros::NodeHandle local_nh("~");
+
+  // the same parameters as the planner, so that the yaml files of the planner can be loaded
+  std::string file;
+  double max_library_size, max_velocity, max_yawrate, min_velocity, predict_time, resolution;
+  int sim_time_samples;
+  local_nh.param<std::string>("FILE", file, std::string("primitive_library.bin"));
+  local_nh.param<double>("MAX_LIBRARY_SIZE", max_library_size, 100.0);
+  local_nh.param<double>("MAX_VELOCITY", max_velocity, 1.0);
+  local_nh.param<double>("MAX_YAWRATE", max_yawrate, 1.0);
+  local_nh.param<double>("MIN_VELOCITY", min_velocity, 0.0);
+  local_nh.param<double>("PREDICT_TIME", predict_time, 3.0);
+  local_nh.param<double>("PRIMITIVE_RESOLUTION", resolution, 0.01);
+  local_nh.param<int>("SIM_TIME_SAMPLES", sim_time_samples, 10);
+
+  size_t count;
+  const size_t file_size = PrimitiveLibrary::calc_file_size(
+      sim_time_samples, resolution, min_velocity, max_velocity, max_yawrate, count);
+  const double file_size_mb = file_size / (1024.0 * 1024.0);
+  ROS_INFO_STREAM(count << " primitives, " << file_size_mb << " [MB]");
+  if (max_library_size < file_size_mb)
+  {
+    ROS_ERROR_STREAM(
+        "The primitive library exceeds MAX_LIBRARY_SIZE ("
+        << max_library_size << " [MB]), increase PRIMITIVE_RESOLUTION or MAX_LIBRARY_SIZE");
+    return 1;
+  }
+  if (!PrimitiveLibrary::generate(
+          file, predict_time, sim_time_samples, resolution, min_velocity, max_velocity, max_yawrate))
+  {
+    ROS_ERROR_STREAM("Failed to generate the primitive library " << file);
+    return 1;
+  }
+  ROS_INFO_STREAM("Generated the primitive library " << file);
+  return 0;
+}
@@ -0,0 +1,120 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "dwa_planner/ray_table.h"
+
+RayTable::RayTable(void) : angle_resolution_(0.0), ray_begin_(1, 0) {}
+
+bool RayTable::update(const nav_msgs::MapMetaData &info, const double angle_resolution)
+{
+  if (info.resolution == info_.resolution && info.width == info_.width && info.height == info_.height &&
+      info.origin.position.x == info_.origin.position.x && info.origin.position.y == info_.origin.position.y &&
+      angle_resolution == angle_resolution_)
+    return false;
+  info_ = info;
+  angle_resolution_ = angle_resolution;
+
+  cos_.clear();
+  sin_.clear();
+  ray_begin_.assign(1, 0);
+  cell_.clear();
+  dist_.clear();
+  if (angle_resolution_ <= 0.0 || info_.resolution <= 0.0)
+    return true;
+  for (int i = 0; -M_PI + i * angle_resolution_ <= M_PI; i++)
+    trace(-M_PI + i * angle_resolution_);
+  return true;
+}
+
+void RayTable::cast(const std::vector<int8_t> &data, const int num_threads, geometry_msgs::PoseArray &obs_list) const
+{
+  obs_list.poses.clear();
+  if (data.size() != static_cast<size_t>(info_.width) * info_.height)
+    return;
+  const int ray_num = cos_.size();
+  const int thread_num = std::max(std::min(num_threads, ray_num), 1);
+  if (thread_num == 1)
+  {
+    cast(data, 0, ray_num, obs_list.poses);
+    return;
+  }
+
+  // every thread keeps its own hits so that the obstacles stay in the order of rays
+  std::vector<std::vector<geometry_msgs::Pose>> poses(thread_num);
+  std::vector<std::thread> threads;
+  for (int i = 1; i < thread_num; i++)
+    threads.emplace_back([&, i] { cast(data, ray_num * i / thread_num, ray_num * (i + 1) / thread_num, poses[i]); });
+  cast(data, 0, ray_num / thread_num, poses[0]);
+  for (auto &thread : threads)
+    thread.join();
+  for (const auto &hits : poses)
+    obs_list.poses.insert(obs_list.poses.end(), hits.begin(), hits.end());
+}
+
+void RayTable::trace(const double angle)
+{
+  const double resolution = info_.resolution;
+  const double c = cos(angle);
+  const double s = sin(angle);
+  // the rays start from the robot and cover the distance to the map origin
+  const double max_dist = hypot(info_.origin.position.x, info_.origin.position.y) / resolution;
+  const double start_x = -info_.origin.position.x / resolution;
+  const double start_y = -info_.origin.position.y / resolution;
+  int index_x = floor(start_x);
+  int index_y = floor(start_y);
+  const int step_x = 0 < c ? 1 : -1;
+  const int step_y = 0 < s ? 1 : -1;
+  const double delta_x = fabs(c) < DBL_EPSILON ? DBL_MAX : 1.0 / fabs(c);
+  const double delta_y = fabs(s) < DBL_EPSILON ? DBL_MAX : 1.0 / fabs(s);
+  double next_x = fabs(c) < DBL_EPSILON ? DBL_MAX : (0 < c ? index_x + 1 - start_x : start_x - index_x) * delta_x;
+  double next_y = fabs(s) < DBL_EPSILON ? DBL_MAX : (0 < s ? index_y + 1 - start_y : start_y - index_y) * delta_y;
+
+  double dist = 0.0;
+  while (dist <= max_dist)
+  {
+    if ((0 <= index_x && index_x < info_.width) && (0 <= index_y && index_y < info_.height))
+    {
+      cell_.push_back(index_x + index_y * info_.width);
+      dist_.push_back(dist * resolution);
+    }
+    if (next_x < next_y)
+    {
+      dist = next_x;
+      next_x += delta_x;
+      index_x += step_x;
+    }
+    else
+    {
+      dist = next_y;
+      next_y += delta_y;
+      index_y += step_y;
+    }
+  }
+  cos_.push_back(c);
+  sin_.push_back(s);
+  ray_begin_.push_back(cell_.size());
+}
+
+void RayTable::cast(
+    const std::vector<int8_t> &data, const int begin, const int end, std::vector<geometry_msgs::Pose> &poses) const
+{
+  for (int ray = begin; ray < end; ray++)
+  {
+    for (int i = ray_begin_[ray]; i < ray_begin_[ray + 1]; i++)
+    {
+      if (data[cell_[i]] == 100)
+      {
+        geometry_msgs::Pose pose;
+        pose.position.x = dist_[i] * cos_[ray];
+        pose.position.y = dist_[i] * sin_[ray];
+        poses.push_back(pose);
+        break;
+      }
+    }
+  }
+}
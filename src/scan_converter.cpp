@@ -0,0 +1,167 @@
+// Copyright 2020 amsl
+
+#include <cmath>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "dwa_planner/scan_converter.h"
+
+namespace
+{
+/**
+ * @brief The arguments shared by the conversion kernels
+ */
+struct Beams
+{
+  const float *ranges;
+  const float *cos;
+  const float *sin;
+  int size;
+  float range_min;
+  float range_max;
+  float half_length;
+  float half_width;
+  float *x;
+  float *y;
+  uint8_t *valid;
+};
+
+/**
+ * @brief Convert the beams from begin to the end one by one
+ */
+bool convert_scalar(const Beams &beams, const int begin)
+{
+  bool collision = false;
+  for (int i = begin; i < beams.size; i++)
+  {
+    const float r = beams.ranges[i];
+    const float x = r * beams.cos[i];
+    const float y = r * beams.sin[i];
+    beams.x[i] = x;
+    beams.y[i] = y;
+    beams.valid[i] = beams.range_min <= r && r <= beams.range_max;
+    collision |= -beams.half_length <= x && x <= beams.half_length && -beams.half_width <= y && y <= beams.half_width;
+  }
+  return collision;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Convert four beams at a time
+ */
+__attribute__((target("sse2"))) bool convert_sse(const Beams &beams)
+{
+  const __m128 range_min = _mm_set1_ps(beams.range_min);
+  const __m128 range_max = _mm_set1_ps(beams.range_max);
+  const __m128 half_length = _mm_set1_ps(beams.half_length);
+  const __m128 half_width = _mm_set1_ps(beams.half_width);
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  int hits = 0;
+  int i = 0;
+  for (; i + 4 <= beams.size; i += 4)
+  {
+    const __m128 r = _mm_loadu_ps(beams.ranges + i);
+    const __m128 x = _mm_mul_ps(r, _mm_loadu_ps(beams.cos + i));
+    const __m128 y = _mm_mul_ps(r, _mm_loadu_ps(beams.sin + i));
+    _mm_storeu_ps(beams.x + i, x);
+    _mm_storeu_ps(beams.y + i, y);
+    const int valid = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(r, range_min), _mm_cmple_ps(r, range_max)));
+    for (int k = 0; k < 4; k++)
+      beams.valid[i + k] = (valid >> k) & 1;
+    // |x| <= half_length and |y| <= half_width
+    hits |= _mm_movemask_ps(_mm_and_ps(
+        _mm_cmple_ps(_mm_andnot_ps(sign, x), half_length), _mm_cmple_ps(_mm_andnot_ps(sign, y), half_width)));
+  }
+  return convert_scalar(beams, i) || hits != 0;
+}
+
+/**
+ * @brief Convert eight beams at a time
+ */
+__attribute__((target("avx2"))) bool convert_avx2(const Beams &beams)
+{
+  const __m256 range_min = _mm256_set1_ps(beams.range_min);
+  const __m256 range_max = _mm256_set1_ps(beams.range_max);
+  const __m256 half_length = _mm256_set1_ps(beams.half_length);
+  const __m256 half_width = _mm256_set1_ps(beams.half_width);
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  int hits = 0;
+  int i = 0;
+  for (; i + 8 <= beams.size; i += 8)
+  {
+    const __m256 r = _mm256_loadu_ps(beams.ranges + i);
+    const __m256 x = _mm256_mul_ps(r, _mm256_loadu_ps(beams.cos + i));
+    const __m256 y = _mm256_mul_ps(r, _mm256_loadu_ps(beams.sin + i));
+    _mm256_storeu_ps(beams.x + i, x);
+    _mm256_storeu_ps(beams.y + i, y);
+    const int valid = _mm256_movemask_ps(
+        _mm256_and_ps(_mm256_cmp_ps(r, range_min, _CMP_GE_OQ), _mm256_cmp_ps(r, range_max, _CMP_LE_OQ)));
+    for (int k = 0; k < 8; k++)
+      beams.valid[i + k] = (valid >> k) & 1;
+    hits |= _mm256_movemask_ps(_mm256_and_ps(
+        _mm256_cmp_ps(_mm256_andnot_ps(sign, x), half_length, _CMP_LE_OQ),
+        _mm256_cmp_ps(_mm256_andnot_ps(sign, y), half_width, _CMP_LE_OQ)));
+  }
+  return convert_scalar(beams, i) || hits != 0;
+}
+#endif
+
+/**
+ * @brief Select the widest kernel the CPU supports
+ */
+bool convert_beams(const Beams &beams)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  static const bool has_sse2 = __builtin_cpu_supports("sse2");
+  if (has_avx2)
+    return convert_avx2(beams);
+  if (has_sse2)
+    return convert_sse(beams);
+#endif
+  return convert_scalar(beams, 0);
+}
+}  // namespace
+
+ScanConverter::ScanConverter(void) : angle_min_(0.0), angle_increment_(0.0) {}
+
+bool ScanConverter::convert(const sensor_msgs::LaserScan &scan, const float half_length, const float half_width)
+{
+  update_tables(scan);
+  x_.resize(scan.ranges.size());
+  y_.resize(scan.ranges.size());
+  valid_.resize(scan.ranges.size());
+
+  Beams beams;
+  beams.ranges = scan.ranges.data();
+  beams.cos = cos_.data();
+  beams.sin = sin_.data();
+  beams.size = scan.ranges.size();
+  beams.range_min = scan.range_min;
+  beams.range_max = scan.range_max;
+  beams.half_length = half_length;
+  beams.half_width = half_width;
+  beams.x = x_.data();
+  beams.y = y_.data();
+  beams.valid = valid_.data();
+  return convert_beams(beams);
+}
+
+void ScanConverter::update_tables(const sensor_msgs::LaserScan &scan)
+{
+  if (scan.angle_min == angle_min_ && scan.angle_increment == angle_increment_ && scan.ranges.size() == cos_.size())
+    return;
+  angle_min_ = scan.angle_min;
+  angle_increment_ = scan.angle_increment;
+  cos_.resize(scan.ranges.size());
+  sin_.resize(scan.ranges.size());
+  for (size_t i = 0; i < scan.ranges.size(); i++)
+  {
+    const double angle = angle_min_ + i * static_cast<double>(angle_increment_);
+    cos_[i] = cos(angle);
+    sin_[i] = sin(angle);
+  }
+}
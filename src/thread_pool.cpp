@@ -0,0 +1,88 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dwa_planner/thread_pool.h"
+
+ThreadPool::ThreadPool(void)
+    : stopped_(false), generation_(0), busy_workers_(0), num_tasks_(0), next_task_(0), task_(nullptr),
+      context_(nullptr)
+{
+}
+
+ThreadPool::~ThreadPool(void) { stop(); }
+
+void ThreadPool::resize(const int num_threads)
+{
+  const int worker_num = std::max(num_threads, 1) - 1;
+  if (worker_num == workers_.size())
+    return;
+  stop();
+  stopped_ = false;
+  for (int i = 0; i < worker_num; i++)
+    workers_.emplace_back(&ThreadPool::work, this, i + 1, generation_);
+}
+
+void ThreadPool::dispatch(const int num_tasks, void (*task)(const void *, int, int), const void *context)
+{
+  if (workers_.empty() || num_tasks <= 1)
+  {
+    for (int i = 0; i < num_tasks; i++)
+      task(context, i, 0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = task;
+    context_ = context;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    busy_workers_ = workers_.size();
+    generation_++;
+  }
+  start_cv_.notify_all();
+  execute(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+}
+
+void ThreadPool::execute(const int thread)
+{
+  for (int i = next_task_++; i < num_tasks_; i = next_task_++)
+    task_(context_, i, thread);
+}
+
+void ThreadPool::work(const int thread, uint64_t generation)
+{
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&] { return stopped_ || generation_ != generation; });
+      if (stopped_)
+        return;
+      generation = generation_;
+    }
+    execute(thread);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busy_workers_ == 0)
+      done_cv_.notify_one();
+  }
+}
+
+void ThreadPool::stop(void)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto &worker : workers_)
+    worker.join();
+  workers_.clear();
+}
@@ -0,0 +1,47 @@
+// Copyright 2020 amsl
+
+#include <vector>
+
+#include "dwa_planner/trajectory_store.h"
+
+TrajectoryStore::TrajectoryStore(void) : steps_(0) {}
+
+void TrajectoryStore::reset(const int steps, const int critic_count)
+{
+  steps_ = steps;
+  // clear keeps the capacity, so the next cycle refills the same memory
+  velocity_.clear();
+  yawrate_.clear();
+  lateral_velocity_.clear();
+  valid_.clear();
+  obs_cost_.clear();
+  to_goal_cost_.clear();
+  speed_cost_.clear();
+  path_cost_.clear();
+  total_cost_.clear();
+  critic_costs_.resize(critic_count);
+  for (auto &costs : critic_costs_)
+    costs.clear();
+  x_.clear();
+  y_.clear();
+  yaw_.clear();
+}
+
+int TrajectoryStore::add(const double velocity, const double yawrate, const double lateral_velocity)
+{
+  velocity_.push_back(velocity);
+  yawrate_.push_back(yawrate);
+  lateral_velocity_.push_back(lateral_velocity);
+  valid_.push_back(false);
+  obs_cost_.push_back(0.0);
+  to_goal_cost_.push_back(0.0);
+  speed_cost_.push_back(0.0);
+  path_cost_.push_back(0.0);
+  total_cost_.push_back(0.0);
+  for (auto &costs : critic_costs_)
+    costs.push_back(0.0);
+  x_.resize(x_.size() + steps_);
+  y_.resize(y_.size() + steps_);
+  yaw_.resize(yaw_.size() + steps_);
+  return velocity_.size() - 1;
+}
@@ -0,0 +1,25 @@
+// Copyright 2020 amsl
+
+#include <cmath>
+#include <pluginlib/class_list_macros.h>
+
+#include "dwa_planner/yawrate_critic.h"
+
+namespace dwa_planner
+{
+YawrateCritic::YawrateCritic(void) : max_yawrate_(1.0) {}
+
+void YawrateCritic::initialize(const ros::NodeHandle &nh) { nh.param<double>("MAX_YAWRATE", max_yawrate_, 1.0); }
+
+void YawrateCritic::score(const TrajectoryStore &trajectories, const int *indices, const int count, float *costs) const
+{
+  for (int i = 0; i < count; i++)
+  {
+    const int index = indices[i];
+    const double yawrate = fabs(trajectories.yawrate_[index]);
+    costs[index] = max_yawrate_ < yawrate ? INFEASIBLE_COST : yawrate;
+  }
+}
+}  // namespace dwa_planner
+
+PLUGINLIB_EXPORT_CLASS(dwa_planner::YawrateCritic, dwa_planner::CostCritic)
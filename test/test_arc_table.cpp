@@ -0,0 +1,127 @@
+// Copyright 2020 amsl
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "dwa_planner/arc_table.h"
+#include "dwa_planner/primitive_library.h"
+
+namespace
+{
+const double PREDICT_TIME = 3.0;
+const int STEPS = 30;
+
+/**
+ * @brief The state of robot integrated step by step
+ */
+struct State
+{
+  double x = 0.0;
+  double y = 0.0;
+  double yaw = 0.0;
+};
+
+/**
+ * @brief Simulate the robot motion by turning and then moving at every step, as the planner did before the arcs
+ * @param velocity The velocity of robot along its x axis
+ * @param lateral_velocity The velocity of robot along its y axis
+ * @param yawrate The angular velocity of robot
+ * @param steps The number of steps
+ * @return The state at the end of every step
+ */
+std::vector<State> integrate(
+    const double velocity, const double lateral_velocity, const double yawrate, const int steps)
+{
+  const double sim_time_step = PREDICT_TIME / steps;
+  std::vector<State> trajectory;
+  State state;
+  for (int i = 0; i < steps; i++)
+  {
+    state.yaw += yawrate * sim_time_step;
+    state.x += (velocity * cos(state.yaw) - lateral_velocity * sin(state.yaw)) * sim_time_step;
+    state.y += (velocity * sin(state.yaw) + lateral_velocity * cos(state.yaw)) * sim_time_step;
+    trajectory.push_back(state);
+  }
+  return trajectory;
+}
+}  // namespace
+
+TEST(ArcTableTest, RolloutArcIsLimitOfIntegration)
+{
+  const int substeps = 1000;
+  for (const double velocity : {0.0, 0.3, 1.0})
+  {
+    for (const double yawrate : {-1.0, -0.2, 0.0, 1e-17, 0.5, 1.0})
+    {
+      const std::vector<State> fine = integrate(velocity, 0.0, yawrate, STEPS * substeps);
+      const std::vector<State> coarse = integrate(velocity, 0.0, yawrate, STEPS);
+      // the integration leads the heading by half a step on average
+      const double coarse_error = velocity * fabs(yawrate) * PREDICT_TIME * PREDICT_TIME / STEPS;
+      rollout_arc(
+          velocity, yawrate, PREDICT_TIME, STEPS,
+          [&](const int i, const double x, const double y, const double yaw)
+          {
+            const State &state = fine[(i + 1) * substeps - 1];
+            EXPECT_NEAR(x, state.x, coarse_error / substeps + 1e-9);
+            EXPECT_NEAR(y, state.y, coarse_error / substeps + 1e-9);
+            EXPECT_NEAR(yaw, state.yaw, 1e-9);
+            EXPECT_NEAR(x, coarse[i].x, coarse_error + 1e-9);
+            EXPECT_NEAR(y, coarse[i].y, coarse_error + 1e-9);
+            EXPECT_NEAR(yaw, coarse[i].yaw, 1e-9);
+          });
+    }
+  }
+}
+
+TEST(ArcTableTest, RolloutMatchesRolloutArc)
+{
+  ArcTable table;
+  table.reset(PREDICT_TIME, STEPS);
+  std::vector<float> x(STEPS), y(STEPS), yaw(STEPS);
+  for (const double yawrate : {-0.8, 0.0, 0.3})
+  {
+    const int index = table.add(yawrate);
+    EXPECT_EQ(table.add(yawrate), index);
+    table.rollout(index, 0.7, 0.0, x.data(), y.data(), yaw.data());
+    rollout_arc(
+        0.7, yawrate, PREDICT_TIME, STEPS,
+        [&](const int i, const double arc_x, const double arc_y, const double arc_yaw)
+        {
+          EXPECT_NEAR(x[i], arc_x, 1e-5);
+          EXPECT_NEAR(y[i], arc_y, 1e-5);
+          EXPECT_NEAR(yaw[i], arc_yaw, 1e-5);
+        });
+  }
+  EXPECT_EQ(table.size(), 3);
+}
+
+TEST(ArcTableTest, LateralRolloutIsLimitOfIntegration)
+{
+  const int substeps = 1000;
+  ArcTable table;
+  table.reset(PREDICT_TIME, STEPS);
+  std::vector<float> x(STEPS), y(STEPS), yaw(STEPS);
+  for (const double yawrate : {-0.8, 0.0, 0.3})
+  {
+    for (const double lateral_velocity : {-0.4, 0.2})
+    {
+      const int index = table.add(yawrate);
+      table.rollout(index, 0.5, lateral_velocity, x.data(), y.data(), yaw.data());
+      const std::vector<State> fine = integrate(0.5, lateral_velocity, yawrate, STEPS * substeps);
+      for (int i = 0; i < STEPS; i++)
+      {
+        const State &state = fine[(i + 1) * substeps - 1];
+        EXPECT_NEAR(x[i], state.x, 1e-3);
+        EXPECT_NEAR(y[i], state.y, 1e-3);
+        EXPECT_NEAR(yaw[i], state.yaw, 1e-5);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
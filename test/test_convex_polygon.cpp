@@ -0,0 +1,116 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "dwa_planner/convex_polygon.h"
+
+namespace
+{
+/**
+ * @brief Calculate the outward unit normals of the edges of the counterclockwise polygon
+ * @param vertices The vertices of polygon
+ * @return The normal of the edge from every vertex to the next one
+ */
+std::vector<Eigen::Vector2d> calc_edge_normals(const std::vector<Eigen::Vector2d> &vertices)
+{
+  std::vector<Eigen::Vector2d> normals;
+  for (size_t i = 0; i < vertices.size(); i++)
+  {
+    const Eigen::Vector2d edge = vertices[(i + 1) % vertices.size()] - vertices[i];
+    normals.push_back(Eigen::Vector2d(edge.y(), -edge.x()).normalized());
+  }
+  return normals;
+}
+
+/**
+ * @brief Calculate the signed distance by checking every edge
+ * @param point The target point
+ * @param vertices The vertices of the counterclockwise polygon
+ * @return The distance to the boundary, negative inside of the polygon
+ */
+double calc_expected_signed_distance(const Eigen::Vector2d &point, const std::vector<Eigen::Vector2d> &vertices)
+{
+  double min_dist = DBL_MAX;
+  bool is_inside = true;
+  for (size_t i = 0; i < vertices.size(); i++)
+  {
+    const Eigen::Vector2d a = vertices[i];
+    const Eigen::Vector2d edge = vertices[(i + 1) % vertices.size()] - a;
+    const double t = std::min(std::max((point - a).dot(edge) / edge.squaredNorm(), 0.0), 1.0);
+    min_dist = std::min(min_dist, (point - a - t * edge).norm());
+    // a counterclockwise polygon has its inside on the left of every edge
+    if (edge.x() * (point - a).y() - edge.y() * (point - a).x() < 0.0)
+      is_inside = false;
+  }
+  return is_inside ? -min_dist : min_dist;
+}
+}  // namespace
+
+TEST(ConvexPolygonTest, HullIsCounterclockwise)
+{
+  std::vector<Eigen::Vector2d> points = {
+      Eigen::Vector2d(1.0, 1.0), Eigen::Vector2d(-1.0, -1.0), Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(1.0, -1.0),
+      Eigen::Vector2d(-1.0, 1.0), Eigen::Vector2d(0.0, 1.0)};
+  calc_convex_hull(points);
+  ASSERT_EQ(points.size(), 4);
+  EXPECT_EQ(points[0], Eigen::Vector2d(-1.0, -1.0));
+  EXPECT_EQ(points[1], Eigen::Vector2d(1.0, -1.0));
+  EXPECT_EQ(points[2], Eigen::Vector2d(1.0, 1.0));
+  EXPECT_EQ(points[3], Eigen::Vector2d(-1.0, 1.0));
+}
+
+TEST(ConvexPolygonTest, SquareSignedDistance)
+{
+  const std::vector<Eigen::Vector2d> square = {
+      Eigen::Vector2d(-1.0, -1.0), Eigen::Vector2d(1.0, -1.0), Eigen::Vector2d(1.0, 1.0), Eigen::Vector2d(-1.0, 1.0)};
+  const std::vector<Eigen::Vector2d> normals = calc_edge_normals(square);
+  EXPECT_DOUBLE_EQ(calc_signed_distance_to_convex_polygon(Eigen::Vector2d(0.0, 0.0), square, normals), -1.0);
+  EXPECT_DOUBLE_EQ(calc_signed_distance_to_convex_polygon(Eigen::Vector2d(0.5, 0.2), square, normals), -0.5);
+  EXPECT_DOUBLE_EQ(calc_signed_distance_to_convex_polygon(Eigen::Vector2d(3.0, 0.5), square, normals), 2.0);
+  // the nearest point is the corner
+  EXPECT_DOUBLE_EQ(calc_signed_distance_to_convex_polygon(Eigen::Vector2d(4.0, 5.0), square, normals), 5.0);
+  EXPECT_TRUE(is_inside_of_convex_polygon(Eigen::Vector2d(0.9, -0.9), square, normals));
+  EXPECT_FALSE(is_inside_of_convex_polygon(Eigen::Vector2d(1.1, 0.0), square, normals));
+}
+
+TEST(ConvexPolygonTest, RandomSignedDistance)
+{
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> position(-1.0, 1.0);
+  std::uniform_real_distribution<double> query(-2.0, 2.0);
+  for (int polygon = 0; polygon < 50; polygon++)
+  {
+    std::vector<Eigen::Vector2d> vertices;
+    for (int i = 0; i < 8; i++)
+      vertices.push_back(Eigen::Vector2d(position(engine), position(engine)));
+    calc_convex_hull(vertices);
+    const std::vector<Eigen::Vector2d> normals = calc_edge_normals(vertices);
+    for (int i = 0; i < 200; i++)
+    {
+      const Eigen::Vector2d point(query(engine), query(engine));
+      const double expected = calc_expected_signed_distance(point, vertices);
+      EXPECT_NEAR(calc_signed_distance_to_convex_polygon(point, vertices, normals), expected, 1e-12);
+      EXPECT_EQ(is_inside_of_convex_polygon(point, vertices, normals), expected < 0.0);
+    }
+  }
+}
+
+TEST(ConvexPolygonTest, DegenerateSignedDistance)
+{
+  const std::vector<Eigen::Vector2d> segment = {Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(2.0, 0.0)};
+  const std::vector<Eigen::Vector2d> normals(2, Eigen::Vector2d::Zero());
+  EXPECT_DOUBLE_EQ(calc_signed_distance_to_convex_polygon(Eigen::Vector2d(1.0, 0.5), segment, normals), 0.5);
+  EXPECT_DOUBLE_EQ(calc_signed_distance_to_convex_polygon(Eigen::Vector2d(-3.0, 4.0), segment, normals), 5.0);
+  EXPECT_EQ(calc_signed_distance_to_convex_polygon(Eigen::Vector2d(1.0, 0.5), {}, {}), DBL_MAX);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
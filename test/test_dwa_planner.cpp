@@ -0,0 +1,212 @@
+// Copyright 2020 amsl
+
+#include <cfloat>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <ros/ros.h>
+#include <string>
+#include <vector>
+
+#include "dwa_planner/dwa_planner.h"
+
+/**
+ * @class TestPlanner
+ * @brief The planner with its settings and obstacles set directly by the tests
+ */
+class TestPlanner : public DWAPlanner
+{
+public:
+  /**
+   * @brief Publish obstacles scattered around the robot
+   * @param seed The seed of the random positions
+   */
+  void set_obstacles(const unsigned int seed)
+  {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<double> distribution(-6.0, 6.0);
+    ObstacleSnapshot &snapshot = acquire_obstacle_buffer();
+    snapshot.obs_list_.poses.clear();
+    while (snapshot.obs_list_.poses.size() < 300)
+    {
+      geometry_msgs::Pose pose;
+      pose.position.x = distribution(engine);
+      pose.position.y = distribution(engine);
+      if (0.8 < hypot(pose.position.x, pose.position.y))
+        snapshot.obs_list_.poses.push_back(pose);
+    }
+    publish_obstacle_buffer();
+  }
+
+  /**
+   * @brief Plan one cycle, the obstacles are kept until the next cycle
+   * @param velocity The current velocity
+   * @param yawrate The current yawrate
+   * @param goal The goal in the robot frame
+   * @return The index of the selected trajectory
+   */
+  int plan(const double velocity, const double yawrate, const Eigen::Vector3d &goal)
+  {
+    current_cmd_vel_.linear.x = velocity;
+    current_cmd_vel_.angular.z = yawrate;
+    obstacles_ = std::atomic_load(&obstacle_snapshot_);
+    return dwa_planning(goal);
+  }
+
+  /**
+   * @brief Select the trajectory of the last cycle with the bounds of branch and bound, checking every candidate
+   * against the obstacles
+   * @return The index of the best feasible candidate, -1 if there is none
+   */
+  int select_exhaustively(void)
+  {
+    int best_index = -1;
+    float min_cost = 1e6;
+    for (const int i : candidate_order_)
+    {
+      const float obs_cost = obstacle_critic_.calc_cost(trajectories_, i);
+      if (obs_cost == dwa_planner::CostCritic::INFEASIBLE_COST)
+        continue;
+      Cost cost(
+          obs_cost / (obs_range_ + DBL_EPSILON) * obs_cost_gain_, trajectories_.to_goal_cost_[i] * to_goal_cost_gain_,
+          trajectories_.speed_cost_[i] * speed_cost_gain_, trajectories_.path_cost_[i] * path_cost_gain_, 0.0);
+      cost.critic_cost_ = calc_critic_cost(i);
+      cost.calc_total_cost();
+      if (cost.total_cost_ < min_cost)
+      {
+        min_cost = cost.total_cost_;
+        best_index = i;
+      }
+    }
+    return best_index;
+  }
+
+  /**
+   * @brief Check that the speed costs normalized by the fixed bound are in [0, 1]
+   * @return True if every candidate of the last cycle has a normalized speed cost in [0, 1]
+   */
+  bool has_normalized_speed_costs(void)
+  {
+    for (const int i : candidate_order_)
+    {
+      // the speed at the top of the window leaves a rounding error
+      if (trajectories_.speed_cost_[i] < -DBL_EPSILON || 1.0 + DBL_EPSILON < trajectories_.speed_cost_[i])
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Get the yawrates of the trajectories of the last cycle rejected by the critics
+   * @return The yawrates of the rejected trajectories
+   */
+  std::vector<double> get_rejected_yawrates(void)
+  {
+    std::vector<double> yawrates;
+    for (int i = 0; i < trajectories_.size(); i++)
+    {
+      if (candidate_evaluated_[i] && is_rejected_by_critics(i))
+        yawrates.push_back(trajectories_.yawrate_[i]);
+    }
+    return yawrates;
+  }
+
+  int get_critic_count(void) const { return critics_.size(); }
+  int get_evaluation_threads(void) const { return evaluation_pool_.size(); }
+  double get_yawrate(const int index) const { return trajectories_.yawrate_[index]; }
+
+  void set_branch_and_bound(const bool use_branch_and_bound) { use_branch_and_bound_ = use_branch_and_bound; }
+
+  void set_holonomic(const int lateral_velocity_samples)
+  {
+    use_holonomic_ = true;
+    lateral_velocity_samples_ = lateral_velocity_samples;
+    max_lateral_velocity_ = 0.5;
+  }
+
+  void set_speed_cost(const bool use_speed_cost) { use_speed_cost_ = use_speed_cost; }
+};
+
+TEST(DWAPlannerTest, BranchAndBoundSelectsExhaustiveBest)
+{
+  for (const bool use_holonomic : {false, true})
+  {
+    TestPlanner planner;
+    planner.set_branch_and_bound(true);
+    planner.set_speed_cost(true);
+    if (use_holonomic)
+      planner.set_holonomic(3);
+    for (int cycle = 0; cycle < 20; cycle++)
+    {
+      planner.set_obstacles(cycle);
+      const int best_index =
+          planner.plan(0.3 + 0.01 * cycle, 0.02 * cycle - 0.2, Eigen::Vector3d(3.0, 0.5 * sin(cycle), 0.0));
+      const int exhaustive_index = planner.select_exhaustively();
+      if (exhaustive_index < 0)
+        continue;
+      EXPECT_EQ(best_index, exhaustive_index) << "holonomic: " << use_holonomic << ", cycle: " << cycle;
+      EXPECT_TRUE(planner.has_normalized_speed_costs()) << "holonomic: " << use_holonomic << ", cycle: " << cycle;
+    }
+  }
+}
+
+TEST(DWAPlannerTest, CriticPluginRejectsTrajectories)
+{
+  const double max_yawrate = 0.1;
+  const Eigen::Vector3d goal(2.0, 1.5, 0.0);
+  TestPlanner unconstrained_planner;
+  unconstrained_planner.set_obstacles(0);
+  const int unconstrained_index = unconstrained_planner.plan(0.2, 0.0, goal);
+  ASSERT_LE(0, unconstrained_index);
+  // the critic would change the selection
+  ASSERT_LT(max_yawrate, fabs(unconstrained_planner.get_yawrate(unconstrained_index)));
+
+  ros::NodeHandle local_nh("~");
+  local_nh.setParam("CRITICS", std::vector<std::string>{"yawrate"});
+  local_nh.setParam("yawrate/CLASS", "dwa_planner/YawrateCritic");
+  local_nh.setParam("yawrate/MAX_YAWRATE", max_yawrate);
+  TestPlanner planner;
+  local_nh.deleteParam("CRITICS");
+  local_nh.deleteParam("yawrate");
+  ASSERT_EQ(planner.get_critic_count(), 1);
+  for (const bool use_branch_and_bound : {false, true})
+  {
+    planner.set_branch_and_bound(use_branch_and_bound);
+    planner.set_obstacles(0);
+    const int best_index = planner.plan(0.2, 0.0, goal);
+    ASSERT_LE(0, best_index);
+    EXPECT_LE(fabs(planner.get_yawrate(best_index)), max_yawrate);
+    const std::vector<double> rejected_yawrates = planner.get_rejected_yawrates();
+    EXPECT_FALSE(rejected_yawrates.empty());
+    for (const double yawrate : rejected_yawrates)
+      EXPECT_LT(max_yawrate, fabs(yawrate));
+  }
+}
+
+TEST(DWAPlannerTest, EvaluationThreadsSelectSameTrajectory)
+{
+  TestPlanner single_thread_planner;
+  ros::NodeHandle local_nh("~");
+  local_nh.setParam("EVALUATION_THREADS", 4);
+  TestPlanner planner;
+  local_nh.deleteParam("EVALUATION_THREADS");
+  ASSERT_EQ(single_thread_planner.get_evaluation_threads(), 1);
+  ASSERT_EQ(planner.get_evaluation_threads(), 4);
+  for (int cycle = 0; cycle < 20; cycle++)
+  {
+    single_thread_planner.set_obstacles(cycle);
+    planner.set_obstacles(cycle);
+    const double velocity = 0.3 + 0.01 * cycle;
+    const double yawrate = 0.02 * cycle - 0.2;
+    const Eigen::Vector3d goal(3.0, 0.5 * sin(cycle), 0.0);
+    EXPECT_EQ(planner.plan(velocity, yawrate, goal), single_thread_planner.plan(velocity, yawrate, goal))
+        << "cycle: " << cycle;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_dwa_planner");
+  return RUN_ALL_TESTS();
+}
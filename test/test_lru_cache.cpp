@@ -0,0 +1,74 @@
+// Copyright 2020 amsl
+
+#include <gtest/gtest.h>
+
+#include "dwa_planner/lru_cache.h"
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsed)
+{
+  LruCache<int> cache(3);
+  cache.emplace(1) = 10;
+  cache.emplace(2) = 20;
+  cache.emplace(3) = 30;
+  // using 1 leaves 2 as the least recently used
+  ASSERT_NE(cache.find(1), nullptr);
+  EXPECT_EQ(*cache.find(1), 10);
+  cache.emplace(4) = 40;
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache.find(2), nullptr);
+  ASSERT_NE(cache.find(1), nullptr);
+  ASSERT_NE(cache.find(3), nullptr);
+  ASSERT_NE(cache.find(4), nullptr);
+  EXPECT_EQ(*cache.find(3), 30);
+  EXPECT_EQ(*cache.find(4), 40);
+}
+
+TEST(LruCacheTest, ReusesEvictedStorage)
+{
+  LruCache<int> cache(2);
+  cache.emplace(1) = 10;
+  int *second = &cache.emplace(2);
+  *second = 20;
+  cache.find(2);
+  // the value of 1 is evicted and its storage is handed out for 3
+  int *third = &cache.emplace(3);
+  *third = 30;
+  EXPECT_EQ(cache.find(1), nullptr);
+  EXPECT_EQ(cache.find(2), second);
+  EXPECT_EQ(cache.find(3), third);
+  EXPECT_EQ(*second, 20);
+}
+
+TEST(LruCacheTest, SetCapacityEvicts)
+{
+  LruCache<int> cache(4);
+  for (int key = 0; key < 4; key++)
+    cache.emplace(key) = key;
+  cache.find(0);
+  cache.set_capacity(2);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_NE(cache.find(0), nullptr);
+  EXPECT_NE(cache.find(3), nullptr);
+  EXPECT_EQ(cache.find(1), nullptr);
+  EXPECT_EQ(cache.find(2), nullptr);
+}
+
+TEST(LruCacheTest, KeepsOneValueAtZeroCapacity)
+{
+  LruCache<int> cache(0);
+  cache.emplace(1) = 10;
+  cache.emplace(2) = 20;
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.find(1), nullptr);
+  ASSERT_NE(cache.find(2), nullptr);
+  EXPECT_EQ(*cache.find(2), 20);
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.find(2), nullptr);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
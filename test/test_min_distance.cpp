@@ -0,0 +1,84 @@
+// Copyright 2020 amsl
+
+#include <cfloat>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "dwa_planner/min_distance.h"
+
+namespace
+{
+/**
+ * @brief Check that the kernel gives the same result as the scalar loop, bit for bit
+ * @param kernel The kernel
+ */
+void expect_same_as_scalar(const MinDistanceKernel kernel)
+{
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<float> position(-5.0, 5.0);
+  // the obstacle counts cover the tails of every vector width
+  for (int obs_num = 0; obs_num <= 40; obs_num++)
+  {
+    std::vector<float> state_x(30), state_y(30), obs_x(obs_num), obs_y(obs_num);
+    for (int i = 0; i < state_x.size(); i++)
+    {
+      state_x[i] = position(engine);
+      state_y[i] = position(engine);
+    }
+    for (int i = 0; i < obs_num; i++)
+    {
+      obs_x[i] = position(engine);
+      obs_y[i] = position(engine);
+    }
+    for (const float collision_sq_dist : {0.0f, 0.05f, 1.0f})
+    {
+      float expected = FLT_MAX;
+      const bool expected_collision = calc_min_squared_distance(
+          MinDistanceKernel::SCALAR, state_x.data(), state_y.data(), state_x.size(), obs_x.data(), obs_y.data(),
+          obs_num, collision_sq_dist, expected);
+      float actual = FLT_MAX;
+      const bool collision = calc_min_squared_distance(
+          kernel, state_x.data(), state_y.data(), state_x.size(), obs_x.data(), obs_y.data(), obs_num,
+          collision_sq_dist, actual);
+      EXPECT_EQ(collision, expected_collision) << "obstacles: " << obs_num;
+      EXPECT_EQ(actual, expected) << "obstacles: " << obs_num;
+    }
+  }
+}
+}  // namespace
+
+TEST(MinDistanceTest, ScalarFindsMinimum)
+{
+  const float state_x[] = {0.0, 1.0};
+  const float state_y[] = {0.0, 0.0};
+  const float obs_x[] = {3.0, 1.0, -2.0};
+  const float obs_y[] = {0.0, 2.0, 0.0};
+  float min_sq_dist = FLT_MAX;
+  EXPECT_FALSE(
+      calc_min_squared_distance(MinDistanceKernel::SCALAR, state_x, state_y, 2, obs_x, obs_y, 3, 1.0, min_sq_dist));
+  EXPECT_EQ(min_sq_dist, 4.0);
+  // stops at the state closer than the collision distance
+  EXPECT_TRUE(
+      calc_min_squared_distance(MinDistanceKernel::SCALAR, state_x, state_y, 2, obs_x, obs_y, 3, 5.0, min_sq_dist));
+}
+
+TEST(MinDistanceTest, Avx2MatchesScalar)
+{
+  if (!is_supported(MinDistanceKernel::AVX2))
+    GTEST_SKIP();
+  expect_same_as_scalar(MinDistanceKernel::AVX2);
+}
+
+TEST(MinDistanceTest, Avx512MatchesScalar)
+{
+  if (!is_supported(MinDistanceKernel::AVX512))
+    GTEST_SKIP();
+  expect_same_as_scalar(MinDistanceKernel::AVX512);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
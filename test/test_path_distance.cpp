@@ -0,0 +1,115 @@
+// Copyright 2020 amsl
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+#include "dwa_planner/path_distance.h"
+
+namespace
+{
+const double RESOLUTION = 0.05;
+const double REACH = 4.0;
+
+/**
+ * @brief Make a long winding path
+ * @param vertices The number of vertices
+ * @return The vertices of the path, one per column
+ */
+Eigen::Matrix2Xd make_path(const int vertices)
+{
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> turn(-0.8, 0.8);
+  std::uniform_real_distribution<double> length(0.1, 3.0);
+  Eigen::Matrix2Xd path(2, vertices);
+  path.col(0) << -5.0, 2.0;
+  double yaw = 0.0;
+  for (int i = 1; i < vertices; i++)
+  {
+    yaw += turn(engine);
+    path.col(i) = path.col(i - 1) + length(engine) * Eigen::Vector2d(cos(yaw), sin(yaw));
+  }
+  return path;
+}
+
+/**
+ * @brief Calculate the distance from the position to the polyline by checking every segment
+ * @param path The vertices of the path, one per column
+ * @param point The position
+ * @return The distance to the path
+ */
+double calc_exact_distance(const Eigen::Matrix2Xd &path, const Eigen::Vector2d &point)
+{
+  double min_dist = (point - path.col(0)).norm();
+  for (int i = 1; i < path.cols(); i++)
+  {
+    const Eigen::Vector2d segment = path.col(i) - path.col(i - 1);
+    const double t =
+        std::min(std::max((point - path.col(i - 1)).dot(segment) / std::max(segment.squaredNorm(), DBL_EPSILON), 0.0),
+                 1.0);
+    min_dist = std::min(min_dist, (point - (path.col(i - 1) + t * segment)).norm());
+  }
+  return min_dist;
+}
+}  // namespace
+
+TEST(PathDistanceTest, MatchesExactDistanceAlongPath)
+{
+  const Eigen::Matrix2Xd path = make_path(500);
+  PathDistance path_distance;
+  path_distance.set_path(path);
+  std::mt19937 engine(1);
+  std::uniform_real_distribution<double> offset(-REACH, REACH);
+  // the grid keeps the samples of the path within half a cell, and the lookup overestimates by up to the diagonal
+  const double tolerance = 0.5 * RESOLUTION + M_SQRT2 * RESOLUTION;
+  for (int i = 0; i < path.cols(); i += 10)
+  {
+    const Eigen::Vector2d robot = path.col(i) + Eigen::Vector2d(0.5, -0.3);
+    path_distance.update(robot, RESOLUTION, REACH);
+    for (int k = 0; k < 200; k++)
+    {
+      const Eigen::Vector2d point = robot + Eigen::Vector2d(offset(engine), offset(engine));
+      const double exact = calc_exact_distance(path, point);
+      const double dist = path_distance.distance(point.x(), point.y());
+      EXPECT_NEAR(dist, exact, tolerance) << "vertex: " << i << ", point: " << point.transpose();
+    }
+  }
+}
+
+TEST(PathDistanceTest, BuildsAgainNearEdge)
+{
+  PathDistance path_distance;
+  path_distance.set_path(make_path(500));
+  EXPECT_TRUE(path_distance.update(Eigen::Vector2d(0.0, 0.0), RESOLUTION, REACH));
+  EXPECT_FALSE(path_distance.update(Eigen::Vector2d(0.9 * REACH, -0.9 * REACH), RESOLUTION, REACH));
+  EXPECT_TRUE(path_distance.update(Eigen::Vector2d(1.1 * REACH, 0.0), RESOLUTION, REACH));
+  // a new path is sampled into the grid again
+  path_distance.set_path(make_path(10));
+  EXPECT_TRUE(path_distance.update(Eigen::Vector2d(1.1 * REACH, 0.0), RESOLUTION, REACH));
+}
+
+TEST(PathDistanceTest, FarPositionIsExact)
+{
+  const Eigen::Matrix2Xd path = make_path(500);
+  PathDistance path_distance;
+  path_distance.set_path(path);
+  path_distance.update(Eigen::Vector2d(0.0, 0.0), RESOLUTION, REACH);
+  for (const Eigen::Vector2d &point : {Eigen::Vector2d(100.0, 50.0), Eigen::Vector2d(-30.0, -80.0)})
+    EXPECT_FLOAT_EQ(path_distance.distance(point.x(), point.y()), calc_exact_distance(path, point));
+}
+
+TEST(PathDistanceTest, EmptyPathIsZero)
+{
+  PathDistance path_distance;
+  path_distance.set_path(Eigen::Matrix2Xd());
+  EXPECT_FALSE(path_distance.update(Eigen::Vector2d(0.0, 0.0), RESOLUTION, REACH));
+  EXPECT_EQ(path_distance.distance(1.0, 2.0), 0.0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
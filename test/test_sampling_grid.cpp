@@ -0,0 +1,50 @@
+// Copyright 2020 amsl
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include "dwa_planner/sampling_grid.h"
+
+TEST(SamplingGridTest, SpansRange)
+{
+  const SamplingGrid grid(-1.0, 1.0, 5);
+  ASSERT_EQ(grid.size(), 5);
+  EXPECT_DOUBLE_EQ(grid.resolution(), 0.5);
+  EXPECT_DOUBLE_EQ(grid.sample(0), -1.0);
+  EXPECT_DOUBLE_EQ(grid.sample(2), 0.0);
+  EXPECT_DOUBLE_EQ(grid.sample(4), 1.0);
+}
+
+TEST(SamplingGridTest, SingleSampleIsCentre)
+{
+  const SamplingGrid grid(-0.2, 0.6, 1);
+  ASSERT_EQ(grid.size(), 1);
+  EXPECT_EQ(grid.resolution(), 0.0);
+  EXPECT_DOUBLE_EQ(grid.sample(0), 0.2);
+}
+
+TEST(SamplingGridTest, FewerSamplesAreNotNan)
+{
+  for (int samples = -1; samples <= 1; samples++)
+  {
+    const SamplingGrid grid(0.0, 0.0, samples);
+    EXPECT_EQ(grid.size(), 1);
+    EXPECT_FALSE(std::isnan(grid.resolution()));
+    EXPECT_FALSE(std::isnan(grid.sample(0)));
+    EXPECT_EQ(grid.sample(0), 0.0);
+  }
+}
+
+TEST(SamplingGridTest, EmptyRangeHasPositiveResolution)
+{
+  // the finer grids of adaptive sampling divide the resolution
+  const SamplingGrid grid(0.5, 0.5, 3);
+  EXPECT_GT(grid.resolution(), 0.0);
+  EXPECT_DOUBLE_EQ(grid.sample(0), 0.5);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}